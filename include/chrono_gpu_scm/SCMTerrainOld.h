@@ -24,8 +24,14 @@
 #define SCM_TERRAIN_OLD_H
 
 #include <string>
+#include <cstdint>
 #include <ostream>
 #include <unordered_map>
+#include <unordered_set>
+#include <future>
+#include <atomic>
+#include <thread>
+#include <cstdio>
 
 #include "chrono/core/ChTimer.h"
 #include "chrono/assets/ChVisualShapeTriangleMesh.h"
@@ -86,6 +92,172 @@ class CH_VEHICLE_API SCMTerrainOld : public ChTerrain {
         NodeInfo() = default;
     };
 
+    /// Caller-provided structure-of-arrays buffers for bulk export of node information (see ExportNodeInfo).
+    /// Each non-null buffer must hold at least width x height values; fields with a null buffer are not exported.
+    struct NodeInfoBuffers {
+        double* sinkage = nullptr;          ///< sinkage, along local normal direction
+        double* sinkage_plastic = nullptr;  ///< sinkage due to plastic deformation
+        double* sinkage_elastic = nullptr;  ///< sinkage due to elastic deformation
+        double* sigma = nullptr;            ///< normal pressure
+        double* sigma_yield = nullptr;      ///< yield pressure
+        double* kshear = nullptr;           ///< Janosi-Hanamoto shear
+        double* tau = nullptr;              ///< shear stress
+    };
+
+    /// Node quantities set by a bulk node update, in addition to the node level (see ApplyNodeUpdates).
+    enum NodeUpdateFields {
+        UPDATE_LEVEL = 0,                 ///< node level only
+        UPDATE_SINKAGE_PLASTIC = 1 << 0,  ///< plastic sinkage
+        UPDATE_SIGMA_YIELD = 1 << 1,      ///< yield pressure
+        UPDATE_KSHEAR = 1 << 2            ///< Janosi-Hanamoto shear
+    };
+
+    /// Update of a grid node in a bulk node update (see ApplyNodeUpdates).
+    struct NodeUpdate {
+        ChVector2i ij;               ///< grid location
+        double level = 0;            ///< node level (relative to SCM frame)
+        double sinkage_plastic = 0;  ///< plastic sinkage (used with UPDATE_SINKAGE_PLASTIC)
+        double sigma_yield = 0;      ///< yield pressure (used with UPDATE_SIGMA_YIELD)
+        double kshear = 0;           ///< Janosi-Hanamoto shear (used with UPDATE_KSHEAR)
+    };
+
+    /// Sample format of a raster export (see WriteRaster).
+    enum RasterFormat {
+        RASTER_FLOAT32,  ///< 32-bit floating point values
+        RASTER_UINT16    ///< 16-bit unsigned samples, quantized over the range of exported values
+    };
+
+    /// Output format of a mesh export (see WriteMesh).
+    enum MeshFormat {
+        MESH_OBJ,  ///< Wavefront OBJ (text)
+        MESH_PLY,  ///< binary little-endian PLY (with vertex colors, if available)
+        MESH_STL   ///< binary STL
+    };
+
+    /// Header of a raster export file (see WriteRaster), followed by the raster samples.
+    /// Samples are stored row-major in native byte order, starting at the grid node with the smallest (x,y)
+    /// coordinates. The value of a sample is offset + scale * sample (offset = 0 and scale = 1 for RASTER_FLOAT32).
+    struct RasterHeader {
+        char magic[8];              ///< file signature ("SCMRAST")
+        std::uint32_t version;      ///< file format version
+        std::uint32_t header_size;  ///< size of this header (offset of the raster samples)
+        std::int32_t width;         ///< number of raster columns (grid nodes in X direction)
+        std::int32_t height;        ///< number of raster rows (grid nodes in Y direction)
+        std::int32_t field;         ///< exported node quantity (DataPlotType)
+        std::int32_t format;        ///< sample format (RasterFormat)
+        double x0;                  ///< X coordinate of first sample (in SCM reference plane)
+        double y0;                  ///< Y coordinate of first sample (in SCM reference plane)
+        double delta;               ///< grid spacing
+        double offset;              ///< value offset
+        double scale;               ///< value scale
+    };
+
+    /// Rectangular region of a heightfield texture.
+    struct TextureRect {
+        int x;       ///< first texel column
+        int y;       ///< first texel row
+        int width;   ///< number of texel columns
+        int height;  ///< number of texel rows
+    };
+
+    /// Running aggregate statistics of the terrain deformation (see GetDeformationStats).
+    /// Volumes are obtained by multiplying node quantities by the grid cell area.
+    struct DeformationStats {
+        double plastic_volume = 0;    ///< volume of plastic sinkage (all nodes)
+        double displaced_volume = 0;  ///< cumulative volume displaced from contact patches by plastic flow
+        double deposited_volume = 0;  ///< cumulative net volume deposited by bulldozing
+        double net_volume = 0;        ///< net volume change of the terrain surface relative to the undeformed terrain
+        double max_sinkage = 0;       ///< maximum sinkage reached at any node
+        int num_touched_nodes = 0;    ///< number of grid nodes in contact at last step
+    };
+
+    /// Summary of the terrain state over a cell of the coarse traversability map.
+    struct TraversabilityCell {
+        float level_min;    ///< minimum node level (relative to SCM plane)
+        float level_max;    ///< maximum node level (relative to SCM plane)
+        float level_mean;   ///< mean node level (relative to SCM plane)
+        float sinkage_max;  ///< maximum node sinkage
+        float slope;        ///< maximum terrain slope angle [rad]
+    };
+
+    /// Read-only access to the terrain state at the end of the last completed SCM step (see EnableStateSnapshots).
+    /// A reader can be created and used in any thread, concurrently with the SCM step, without taking locks. All
+    /// queries through a given reader see the same snapshot. Readers should be short-lived: the simulation thread waits
+    /// for all readers of a snapshot to be destroyed before reusing it, two SCM steps later.
+    class CH_VEHICLE_API StateReader {
+      public:
+        StateReader(const SCMTerrainOld& terrain);
+        ~StateReader();
+
+        StateReader(const StateReader&) = delete;
+        StateReader& operator=(const StateReader&) = delete;
+
+        /// Get the terrain height below the specified location.
+        double GetHeight(const ChVector3d& loc) const;
+
+        /// Get the terrain normal at the point below the specified location.
+        ChVector3d GetNormal(const ChVector3d& loc) const;
+
+        /// Get SCM information at the node closest to the specified location.
+        NodeInfo GetNodeInfo(const ChVector3d& loc) const;
+
+        /// Get the sequence number of the snapshot (incremented at each SCM step).
+        unsigned int GetEpoch() const;
+
+      private:
+        std::shared_ptr<SCMLoaderOld> m_loader;  ///< underlying load container
+        int m_snapshot;                          ///< index of snapshot in use (-1 if snapshots are disabled)
+    };
+
+    /// Replay of a terrain deformation log (see StartRecording).
+    /// Recorded frames are reapplied to the terrain (node levels only, see SetModifiedNodes) without running the SCM
+    /// dynamics. Any frame can be reached directly: the replay restarts from the closest preceding keyframe if needed,
+    /// so that frames can be visited at arbitrary speed or in any order. The terrain must be initialized with the same
+    /// patch type and grid as the recorded terrain.
+    class CH_VEHICLE_API DeformationReplay {
+      public:
+        DeformationReplay(SCMTerrainOld& terrain, const std::string& filename);
+        ~DeformationReplay();
+
+        DeformationReplay(const DeformationReplay&) = delete;
+        DeformationReplay& operator=(const DeformationReplay&) = delete;
+
+        /// Get the number of recorded frames.
+        int GetNumFrames() const { return (int)m_frames.size(); }
+
+        /// Get the current frame (-1 if no frame was applied yet).
+        int GetFrame() const { return m_frame; }
+
+        /// Get the simulation time of the specified frame.
+        double GetFrameTime(int frame) const { return m_frames[frame].time; }
+
+        /// Bring the terrain to the state at the specified frame.
+        void Seek(int frame);
+
+        /// Bring the terrain to the state at the last frame recorded at or before the specified time.
+        void SeekTime(double time);
+
+        /// Advance the replay by the specified number of frames.
+        /// Return false (and leave the terrain unchanged) if the end of the log was reached.
+        bool Advance(int frames = 1);
+
+      private:
+        struct FrameInfo {
+            std::int64_t offset;  ///< offset of encoded node levels in the log file
+            size_t size;          ///< size of encoded node levels
+            double time;          ///< simulation time
+            bool keyframe;        ///< all nodes (keyframe) or nodes modified over the step?
+        };
+
+        void ApplyFrame(int frame);
+
+        std::shared_ptr<SCMLoaderOld> m_loader;  ///< underlying load container
+        FILE* m_file;                            ///< log file
+        std::vector<FrameInfo> m_frames;         ///< index of recorded frames
+        std::vector<std::uint8_t> m_buffer;      ///< encoded node levels of current frame
+        int m_frame;                             ///< current frame
+    };
+
     /// Construct a default SCM deformable terrain.
     /// The user is responsible for calling various Set methods before Initialize.
     SCMTerrainOld(ChSystem* system,               ///< [in] containing multibody system
@@ -129,6 +301,17 @@ class CH_VEHICLE_API SCMTerrainOld : public ChTerrain {
         int erosion_propagations = 10  ///< number of concentric vertex selections subject to erosion
     );
 
+    /// Set the rate and execution mode of bulldozing effects (default: every step, synchronous).
+    /// Bulldozing only modifies the terrain geometry seen by later steps. The material displaced at each step is always
+    /// moved to the boundary of the contact patches; with 'interval > 1', the (more expensive) erosion phase which
+    /// spreads this material is evaluated only once every 'interval' SCM steps. If 'async = true', the erosion phase
+    /// runs on a background thread, using a snapshot of the contact patches, and its results are applied at the start of
+    /// the next SCM step, before any other SCM computation (this ordering does not depend on thread timing, so
+    /// simulations remain reproducible). In this mode, terrain queries between steps do not yet include the erosion
+    /// effects of the last step, and the bulldozing timers and counters reported at a given step refer to the job
+    /// applied at the start of that step.
+    void SetBulldozingRate(int interval, bool async = false);
+
     /// Set the vertical level up to which collision is tested (relative to the reference level at the sample point).
     /// Since the contact is unilateral, this could be zero. However, when computing bulldozing flow, one might also
     /// need to know if in the surrounding there is some potential future contact: so it might be better to use a
@@ -220,6 +403,19 @@ class CH_VEHICLE_API SCMTerrainOld : public ChTerrain {
     /// Get the terrain normal at the point below the specified location.
     virtual ChVector3d GetNormal(const ChVector3d& loc) const override;
 
+    /// Get the terrain heights below the specified locations (batched query).
+    /// Unlike GetHeight, which uses the closest grid node, heights are bilinearly interpolated from the 4 grid nodes
+    /// surrounding each location.
+    void GetHeights(const std::vector<ChVector3d>& locs, std::vector<double>& heights) const;
+
+    /// Get the terrain heights and normals below the specified locations (batched query).
+    /// Heights are bilinearly interpolated from the 4 grid nodes surrounding each location and normals are evaluated
+    /// from the gradient of this interpolated height field (finite differences over the grid cell).
+    /// The batched queries reuse internal scratch buffers; they must not be called concurrently on the same terrain.
+    void GetHeightsAndNormals(const std::vector<ChVector3d>& locs,
+                              std::vector<double>& heights,
+                              std::vector<ChVector3d>& normals) const;
+
     /// Get the terrain coefficient of friction at the point below the specified location.
     /// This coefficient of friction value may be used by certain tire models to modify
     /// the tire characteristics, but it will have no effect on the interaction of the terrain
@@ -232,15 +428,128 @@ class CH_VEHICLE_API SCMTerrainOld : public ChTerrain {
     /// Get SCM information at the node closest to the specified location.
     NodeInfo GetNodeInfo(const ChVector3d& loc) const;
 
+    /// Export SCM information at all grid nodes in a rectangular window, in a single pass.
+    /// The window starts at grid node 'start' and spans 'width' x 'height' nodes (grid node (i,j) is located at
+    /// (i*delta, j*delta) in the SCM reference plane). Values are written as raster slices in grid order (node
+    /// (start.x+u, start.y+v) at index u + width*v) into the non-null buffers of 'buffers'. Undeformed nodes are
+    /// reported with zero values, consistent with GetNodeInfo.
+    void ExportNodeInfo(const ChVector2i& start,          ///< [in] first grid node of window
+                        int width,                        ///< [in] number of window nodes in X direction
+                        int height,                       ///< [in] number of window nodes in Y direction
+                        const NodeInfoBuffers& buffers   ///< [in,out] output buffers
+    ) const;
+
+    /// Enable/disable snapshots of the terrain state for concurrent queries (default: false).
+    /// When enabled, the levels and soil quantities of all modified grid nodes are published at the end of each SCM
+    /// step, so that other threads can query the terrain state of the last completed step through a StateReader while
+    /// the next step is computed. Snapshots must not be disabled while readers exist.
+    void EnableStateSnapshots(bool val);
+
     /// Get the visualization triangular mesh.
+    /// If the visualization mesh is tiled (see SetMeshTiling), the returned shape has no geometry; use GetMeshTiles.
     std::shared_ptr<ChVisualShapeTriangleMesh> GetMesh() const;
 
     /// Set the visualization mesh as wireframe or as solid (default: wireframe).
     /// Note: in wireframe mode, normals for the visualization mesh are not calculated.
     void SetMeshWireframe(bool val);
 
-    /// Save the visualization mesh as a Wavefront OBJ file.
-    void WriteMesh(const std::string& filename) const;
+    /// Set the minimum interval of simulation time between two updates of the visualization assets (default: 1/60 s).
+    /// The visualization mesh and textures are updated lazily: deformation accumulated over the SCM steps is applied
+    /// when the visual assets are updated, at most once per interval (the integrators update the assets several times
+    /// per step), and whenever the mesh or textures are requested (GetMesh, GetMeshTiles, WriteMesh, texture getters).
+    /// Set to the frame period of the render loop; with a zero interval, the mesh is updated at every asset update.
+    void SetMeshUpdateInterval(double interval);
+
+    /// Save the visualization mesh (all tiles, if tiled) to a file in the specified format.
+    /// The mesh is streamed directly from the visualization assets: chunks of vertices and faces are formatted in
+    /// parallel into preallocated buffers and written to the file while the next chunks are formatted.
+    void WriteMesh(const std::string& filename,  ///< [in] output file
+                   MeshFormat format = MESH_OBJ  ///< [in] output format
+    ) const;
+
+    /// Write the current node levels (or another node quantity) over the entire patch as a raw raster file.
+    /// The file consists of a RasterHeader followed by one sample per grid node, so that it can be memory mapped by
+    /// analysis tools. The raster is filled and written in bands of rows (filled in parallel, written while the next
+    /// band is filled) and does not require a visualization mesh. The field can be any plot type other than PLOT_NONE;
+    /// undeformed nodes are reported with their initial level (level fields) or zero.
+    void WriteRaster(const std::string& filename,          ///< [in] output file
+                     DataPlotType field = PLOT_LEVEL,      ///< [in] exported node quantity
+                     RasterFormat format = RASTER_FLOAT32  ///< [in] sample format
+    ) const;
+
+    /// Split the visualization mesh into tiles with multiple levels of detail (default: single full-resolution mesh).
+    /// Each tile covers 'tile_size' x 'tile_size' grid cells and is rendered as a separate triangular mesh. At level of
+    /// detail k (0 <= k < num_lods), a tile uses every 2^k-th grid node. Tiles with deformed grid nodes are rendered at
+    /// level floor(d / lod_distance), with d the distance from the tile center to the LOD reference point (see
+    /// SetMeshLODReference); undeformed tiles are always rendered at the coarsest level. Mesh updates are applied only
+    /// to the affected tiles. Tiles are not stitched, so small gaps may be visible between tiles at different levels.
+    /// The number of levels is clamped so that the coarsest stride 2^(num_lods-1) does not exceed the tile size.
+    /// This function must be called before Initialize.
+    void SetMeshTiling(int tile_size, int num_lods, double lod_distance);
+
+    /// Set the reference point (typically the camera position) for selecting the level of detail of mesh tiles.
+    void SetMeshLODReference(const ChVector3d& point);
+
+    /// Get the visualization meshes of all tiles (empty if the visualization mesh is not tiled).
+    std::vector<std::shared_ptr<ChVisualShapeTriangleMesh>> GetMeshTiles() const;
+
+    /// Enable/disable publication of the visualization mesh through triple-buffered snapshots (default: false).
+    /// When enabled, each visualization update also copies the modified mesh vertices (coordinates, normals, colors)
+    /// into a back buffer which is then published without locking. A render thread can consume the latest published
+    /// snapshot with AcquireMeshSnapshot, concurrently with the simulation. Only available with a single (non-tiled)
+    /// visualization mesh. Snapshots may be disabled while the render thread acquires them; the buffers are released
+    /// once no longer used by either thread.
+    void SetMeshSnapshots(bool val);
+
+    /// Acquire the most recently published snapshot of the visualization mesh.
+    /// This function must be called from a single (render) thread. The returned mesh must not be modified and remains
+    /// valid and unchanged until the next call to this function. Return nullptr if no snapshot was published yet.
+    std::shared_ptr<const ChTriangleMeshConnected> AcquireMeshSnapshot();
+
+    /// Enable/disable heightfield texture output (default: false).
+    /// When enabled, each visualization update writes the level (relative to the SCM plane) of all modified grid nodes
+    /// into a height texture with (2*nx+1) x (2*ny+1) texels, stored row-major with texel (0,0) at the grid node with
+    /// the smallest (x,y) coordinates, and the current plot quantity (see SetPlotType) into a scalar texture of the
+    /// same size. The regions changed since they were last queried are available through GetTextureDirtyRects, so that
+    /// an external renderer can upload only these regions and displace a static grid on the GPU. Texture output does
+    /// not require a visualization mesh.
+    void EnableHeightfieldTexture(bool val);
+
+    /// Get the width (number of texel columns) of the heightfield textures.
+    int GetTextureWidth() const;
+
+    /// Get the height (number of texel rows) of the heightfield textures.
+    int GetTextureHeight() const;
+
+    /// Get the height texture (terrain level at each grid node).
+    const std::vector<float>& GetHeightTexture() const;
+
+    /// Get the scalar texture (value of the current plot quantity at each grid node).
+    const std::vector<float>& GetScalarTexture() const;
+
+    /// Get the rectangles of the heightfield textures modified since the last call to this function.
+    /// The first call returns the complete textures.
+    std::vector<TextureRect> GetTextureDirtyRects();
+
+    /// Enable/disable the coarse traversability map (default: false).
+    /// When enabled, the grid nodes are partitioned in square cells of n x n nodes, with n = cell_size/delta (rounded,
+    /// at least 1), starting at the grid node with the smallest (x,y) coordinates. For each cell, the map stores the
+    /// range and mean of the node levels, the maximum sinkage, and the maximum slope angle (evaluated with forward
+    /// differences at each cell node). The map is maintained incrementally: only cells with nodes modified since the
+    /// last query are updated, so that extracting a planning map amounts to copying a contiguous buffer.
+    void EnableTraversabilityMap(bool val, double cell_size = 0.5);
+
+    /// Get the number of cell columns of the traversability map.
+    int GetTraversabilityMapWidth() const;
+
+    /// Get the number of cell rows of the traversability map.
+    int GetTraversabilityMapHeight() const;
+
+    /// Get the actual cell size of the traversability map (a multiple of the grid spacing).
+    double GetTraversabilityCellSize() const;
+
+    /// Get the traversability map, stored row-major with cell (0,0) at the smallest (x,y) coordinates.
+    const std::vector<TraversabilityCell>& GetTraversabilityMap() const;
 
     /// Enable/disable co-simulation mode (default: false).
     /// In co-simulation mode, the underlying SCM loader does not apply loads to interacting objects.
@@ -301,9 +610,140 @@ class CH_VEHICLE_API SCMTerrainOld : public ChTerrain {
     /// modified over the last step.
     std::vector<NodeLevel> GetModifiedNodes(bool all_nodes = false) const;
 
+    /// Visit the heights of all modified grid nodes, without allocation or copying.
+    /// The visitor is invoked as visitor(const ChVector2i& ij, double level) once for each grid node modified over
+    /// the last step (row after row) or, if 'all_nodes = true', for each node modified from the start of simulation (in
+    /// unspecified order). Nodes are visited in place, so the grid locations passed to the visitor are only valid until
+    /// the next step or modification of the terrain.
+    template <typename Visitor>
+    void VisitModifiedNodes(Visitor visitor, bool all_nodes = false) const;
+
+    /// Get the heights of modified grid nodes within an axis-aligned box of the SCM plane.
+    /// The box is specified through its minimum and maximum corners, expressed in the SCM reference plane (i.e., in
+    /// the same frame as the grid node locations).  Nodes are located through a spatial index, so that the cost of
+    /// this query scales with the size of the result rather than with the total number of modified nodes.
+    std::vector<NodeLevel> GetModifiedNodes(const ChVector2d& min,  ///< [in] minimum corner of query box
+                                            const ChVector2d& max,  ///< [in] maximum corner of query box
+                                            bool all_nodes = false  ///< [in] all modified nodes or last step only
+    ) const;
+
+    /// Get the heights of modified grid nodes within a polygon of the SCM plane.
+    /// The polygon (not necessarily convex) is specified through its vertices, expressed in the SCM reference plane.
+    std::vector<NodeLevel> GetModifiedNodes(const std::vector<ChVector2d>& polygon,  ///< [in] polygon vertices
+                                            bool all_nodes = false  ///< [in] all modified nodes or last step only
+    ) const;
+
     /// Modify the level of grid nodes from the given list.
     void SetModifiedNodes(const std::vector<NodeLevel>& nodes);
 
+    /// Encode the heights of modified grid nodes (see GetModifiedNodes) in a compact delta format.
+    /// This format is meant for the exchange of terrain changes between co-simulation nodes. Nodes are sorted by grid
+    /// row and grouped in runs of consecutive nodes; grid indices and levels are coded as variable-length integers,
+    /// with levels quantized to the given resolution relative to the undeformed terrain height. The decoding terrain
+    /// must be initialized with the same patch and grid.
+    void EncodeModifiedNodes(std::vector<std::uint8_t>& buffer,  ///< [out] encoded nodes (overwritten)
+                             double resolution = 1e-5,           ///< [in] level quantization step
+                             bool all_nodes = false              ///< [in] all modified nodes or last step only
+    ) const;
+
+    /// Decode the heights of grid nodes encoded with EncodeModifiedNodes.
+    /// An exception is thrown if the buffer does not hold valid encoded nodes.
+    std::vector<NodeLevel> DecodeModifiedNodes(const std::uint8_t* data, size_t size) const;
+
+    /// Modify the level of grid nodes encoded with EncodeModifiedNodes.
+    /// Nodes are applied as with SetModifiedNodes. The whole buffer is validated first: an exception is thrown if it
+    /// does not hold valid encoded nodes, in which case the terrain is left unchanged.
+    void SetModifiedNodes(const std::uint8_t* data, size_t size);
+
+    /// Apply a batch of grid node updates, preserving the deformation history of the nodes.
+    /// Unlike SetModifiedNodes, node records are not reset: a level change is applied as material added to or removed
+    /// from the node (as in bulldozing), so that plastic sinkage, yield pressure, and shear history are kept, unless
+    /// these quantities are set through 'fields' (a combination of NodeUpdateFields). If the plastic sinkage is set,
+    /// the node is considered unloaded at the given level. Updates must be sorted row after row (by Y, then X grid
+    /// index) without duplicates; an exception is thrown otherwise. The batch is merged into the grid in one pass.
+    void ApplyNodeUpdates(const std::vector<NodeUpdate>& updates, int fields = UPDATE_LEVEL);
+
+    /// Write a binary checkpoint of the complete SCM terrain state.
+    /// Unlike GetModifiedNodes, the checkpoint includes all grid node records (levels, sinkage, pressure and shear
+    /// history, bulldozing quantities), the erosion domain, the state of a deferred bulldozing job, the aggregate
+    /// deformation statistics, and the soil and bulldozing parameters. Active domains (recomputed at every step from
+    /// the body positions), user callbacks, and visualization settings are not included. The file is written with
+    /// sequential I/O. A pending asynchronous bulldozing job is completed first.
+    /// A full checkpoint starts a new checkpoint chain, which can be extended with WriteCheckpointDelta.
+    void WriteCheckpoint(const std::string& filename);
+
+    /// Write an incremental checkpoint, relative to the previous checkpoint of the current chain.
+    /// Only the node records in the tiles (square regions of 32x32 grid nodes) modified since the previous checkpoint
+    /// are written, together with the (small) erosion and bulldozing state, statistics, and parameters. An exception is
+    /// thrown if no chain was started with WriteCheckpoint or ReadCheckpoint.
+    void WriteCheckpointDelta(const std::string& filename);
+
+    /// Restore the SCM terrain state from a binary checkpoint (see WriteCheckpoint).
+    /// The terrain must be initialized with the same patch type and grid as the terrain which wrote the checkpoint;
+    /// an exception is thrown otherwise, or if the file is not a valid checkpoint of the current version. The file is
+    /// memory mapped (where supported) and node records are restored directly from the mapped data.
+    void ReadCheckpoint(const std::string& filename);
+
+    /// Restore the SCM terrain state from a checkpoint chain: a full checkpoint followed by its consecutive deltas.
+    /// Files are applied newest first, so that each grid node is restored once. Subsequent deltas extend this chain.
+    void ReadCheckpoint(const std::vector<std::string>& filenames);
+
+    /// Merge a checkpoint chain (a full checkpoint followed by its consecutive deltas) into a single full checkpoint.
+    /// The compacted checkpoint can replace the chain: further deltas of the chain can be applied on top of it, and
+    /// its restore time depends only on the size of the final state.
+    static void CompactCheckpoints(const std::vector<std::string>& filenames, const std::string& filename);
+
+    /// Start recording the terrain deformation to a log file, for later replay (see DeformationReplay).
+    /// At each SCM step, the levels of the grid nodes modified over the step are encoded in the compact delta format
+    /// (see EncodeModifiedNodes) and queued in a lock-free ring buffer; a background thread flushes queued frames to
+    /// the log file. All grid nodes are recorded (keyframe) every 'keyframe_interval' steps and at the first step after
+    /// the terrain was modified outside the SCM step (e.g., with SetModifiedNodes or ReadCheckpoint). Frames are never
+    /// dropped: if the ring buffer is full (the log file is written slower than frames are produced), the SCM step
+    /// blocks until the background thread has written the oldest queued frame, so 'buffer_frames' should cover the
+    /// expected I/O stalls. A previous recording is stopped first.
+    void StartRecording(const std::string& filename,  ///< [in] log file
+                        int keyframe_interval = 100,   ///< [in] number of steps between keyframes
+                        double resolution = 1e-5,      ///< [in] level quantization step
+                        int buffer_frames = 64         ///< [in] capacity of the ring buffer (frames)
+    );
+
+    /// Stop recording the terrain deformation, after flushing all queued frames to the log file.
+    /// An exception is thrown if the log file could not be written.
+    void StopRecording();
+
+    /// Split the SCM grid into rectangular subdomains simulated by separate processes on the same machine.
+    /// The grid is divided into num_x x num_y subdomains of (nearly) equal size, numbered row after row; this process
+    /// owns subdomain 'rank'. Each process casts rays, finds contact patches, and performs bulldozing over its
+    /// subdomain extended by a ghost layer of 'halo' grid nodes, but updates soil quantities and contact forces only at
+    /// the nodes it owns. At the end of each SCM step, the records of owned nodes modified within the ghost layer of a
+    /// neighboring subdomain are exchanged through a POSIX shared-memory segment with the given name, so that contact
+    /// patches and bulldozing crossing subdomain boundaries see the current neighbor nodes. Material that bulldozing
+    /// moves onto ghost nodes is sent to their owner. The ghost layer should be at least as wide as the bulldozing
+    /// erosion propagation (see SetBulldozingParameters). Deformation statistics (see GetDeformationStats) cover the
+    /// local grid, including the ghost layer. Contact forces on shared bodies (see AddSharedBody) are summed over all
+    /// subdomains and applied only by the owner of the body, i.e. the process whose subdomain contains the projection
+    /// of the body COM; all processes must hold the same body states. This function must be called after Initialize, by
+    /// all processes with the same arguments except 'rank'. It blocks until all processes attached to the segment (the
+    /// segment name is then removed). Each SCM step also waits for all processes. With asynchronous bulldozing (see
+    /// SetBulldozingRate), the data received while a bulldozing job runs is applied once the job completes, at the
+    /// latest at the start of the next step. An exception is thrown if the decomposition is invalid or not supported on
+    /// this platform, or if the segment was left over by an interrupted run (the segment is then removed).
+    void SetDomainDecomposition(const std::string& name,    ///< [in] name of the shared-memory segment
+                                int num_x,                  ///< [in] number of subdomains in X direction
+                                int num_y,                  ///< [in] number of subdomains in Y direction
+                                int rank,                   ///< [in] subdomain owned by this process
+                                int halo = 8,               ///< [in] width of the ghost layer (grid nodes)
+                                int max_shared_bodies = 64  ///< [in] maximum number of shared bodies
+    );
+
+    /// Register a body which may interact with several subdomains (see SetDomainDecomposition).
+    /// The identifier (0 <= id < max_shared_bodies) must designate the same body in all processes. Contact forces on
+    /// bodies which are not registered are applied by the process which computes them.
+    void AddSharedBody(std::shared_ptr<ChBody> body, int id);
+
+    /// Get the range of grid indices owned by this process (the entire grid without domain decomposition).
+    void GetSubdomainRange(ChVector2i& min, ChVector2i& max) const;
+
     /// Return the cummulative contact force on the specified body  (due to interaction with the SCM terrain).
     /// The return value is true if the specified body experiences contact forces and false otherwise.
     /// If contact forces are applied to the body, they are reduced to the body center of mass.
@@ -322,6 +762,9 @@ class CH_VEHICLE_API SCMTerrainOld : public ChTerrain {
     /// Return the number of nodes in the erosion domain at last step (bulldosing effects).
     int GetNumErosionNodes() const;
 
+    /// Return time for exchanging ghost nodes and shared body forces with other subdomains at last step (ms).
+    double GetTimerSubdomainExchange() const;
+
     /// Return time for updating active domains at last step (ms).
     double GetTimerActiveDomains() const;
     /// Return time for geometric ray intersection tests at last step (ms).
@@ -334,9 +777,17 @@ class CH_VEHICLE_API SCMTerrainOld : public ChTerrain {
     double GetTimerContactForces() const;
     /// Return time for computing bulldozing effects at last step (ms).
     double GetTimerBulldozing() const;
-    /// Return time for visualization assets update at last step (ms).
+    /// Return time for visualization assets updates since the beginning of the last step (ms).
+    /// The visualization mesh is updated lazily (see SetMeshUpdateInterval), so this is zero for steps without mesh
+    /// update and the cost of the mesh follows the rendering rate rather than the simulation step rate.
     double GetTimerVisUpdate() const;
 
+    /// Return the running aggregate statistics of the terrain deformation.
+    /// These are updated in the same passes that modify grid nodes and are available at any step without traversing
+    /// the grid. With deferred bulldozing (see SetBulldozingRate), the effects of a bulldozing job are included once
+    /// the job is collected, at the next SCM step.
+    const DeformationStats& GetDeformationStats() const;
+
     /// Print timing and counter information for last step.
     void PrintStepStatistics(std::ostream& os) const;
 
@@ -372,7 +823,18 @@ class CH_VEHICLE_API SCMContactableData {
 class CH_VEHICLE_API SCMLoaderOld : public ChLoadContainer {
   public:
     SCMLoaderOld(ChSystem* system, bool visualization_mesh);
-    ~SCMLoaderOld() {}
+    ~SCMLoaderOld() {
+        if (m_bulldozing_future.valid())
+            m_bulldozing_future.wait();
+        if (m_recorder) {
+            try {
+                StopRecording();
+            } catch (std::exception&) {
+            }
+        }
+        if (m_decomposition)
+            CloseDomainDecomposition();
+    }
 
     /// Initialize the terrain system (flat).
     /// This version creates a flat array of points.
@@ -434,6 +896,7 @@ class CH_VEHICLE_API SCMLoaderOld : public ChLoadContainer {
         double kshear;             // along local tangent direction
         double tau;                // along local tangent direction
         bool erosion;              // for bulldozing
+        int erosion_hops;          // for bulldozing (distance to patch boundary, -1 if not in erosion domain)
         double massremainder;      // for bulldozing
         double step_plastic_flow;  // for bulldozing
 
@@ -453,6 +916,7 @@ class CH_VEHICLE_API SCMLoaderOld : public ChLoadContainer {
               kshear(0),
               tau(0),
               erosion(false),
+              erosion_hops(-1),
               massremainder(0),
               step_plastic_flow(0) {}
     };
@@ -464,9 +928,251 @@ class CH_VEHICLE_API SCMLoaderOld : public ChLoadContainer {
         std::size_t operator()(const ChVector2i& p) const { return p.x() * 31 + p.y(); }
     };
 
+    // Ordering of integer grid coordinates (row after row, same as the visualization mesh vertices)
+    struct CoordLess {
+      public:
+        bool operator()(const ChVector2i& a, const ChVector2i& b) const {
+            return a.y() < b.y() || (a.y() == b.y() && a.x() < b.x());
+        }
+    };
+
+    // Set of grid nodes
+    typedef std::unordered_set<ChVector2i, CoordHash> NodeSet;
+
+    // Bulldozing job (snapshot of contact patches, parameters, and erosion domain; bulldozing results).
+    // While a job runs, it owns the erosion domain state, which is swapped back into the loader when the job completes.
+    struct BulldozingJob {
+        std::vector<std::vector<ChVector2i>> patches;                 // grid nodes in each contact patch
+        double flow_factor = 0;                                       // growth of lateral volume (job parameter)
+        double erosion_slope = 0;                                     // slope of erosion (job parameter)
+        int erosion_iterations = 0;                                   // erosion refinements (job parameter)
+        int erosion_propagations = 0;                                 // erosion propagations (job parameter)
+        double step = 0;                                              // integration step size (job parameter)
+        int nthreads = 1;                                             // number of threads (job parameter)
+        NodeSet domain;                                               // erosion domain (while the job runs)
+        NodeSet boundary;                                             // patch boundaries (while the job runs)
+        NodeSet touched;                                              // touched nodes (while the job runs)
+        int rank = -1;                                                // owned subdomain (-1: entire grid)
+        std::vector<std::pair<ChVector2i, double>> remote;            // material for nodes of other subdomains
+        std::unordered_map<ChVector2i, NodeRecord, CoordHash> nodes;  // modified node records (deferred job only)
+        std::vector<ChVector2i> modified;                             // grid nodes modified by bulldozing
+        int num_erosion_nodes = 0;                                    // number of nodes in erosion domain
+        double displaced = 0;                                         // material displaced from contact patches
+        double deposited = 0;                                         // net change in node levels
+        ChTimer timer_boundary;                                       // timer for raising patch boundaries
+        ChTimer timer_domain;                                         // timer for updating the erosion domain
+        ChTimer timer_erosion;                                        // timer for erosion
+        bool pending = false;                                         // results not yet collected?
+    };
+
+    // Tile of the visualization mesh (tiled level-of-detail mode)
+    struct MeshTile {
+        std::shared_ptr<ChVisualShapeTriangleMesh> shape;  // tile visualization asset
+        ChVector2i origin;                                 // grid location of lower-left tile node
+        ChVector2i cells;                                  // number of grid cells in X and Y directions
+        int lod = -1;                                      // current level of detail (-1 if not yet built)
+        bool deformed = false;                             // tile includes modified grid nodes?
+        std::vector<int> vertices;                         // modified tile mesh vertices (each listed once)
+        std::vector<bool> dirty;                           // per-vertex flags (vertex already in list?)
+    };
+
+    // Triple-buffered snapshots of the visualization mesh (lock-free publication to a render thread)
+    struct MeshSnapshots {
+        std::shared_ptr<ChTriangleMeshConnected> buffers[3];  // mesh buffers
+        std::vector<int> pending[3];                          // vertices modified since buffer was last written
+        std::atomic<int> ready{1};                            // last published buffer (+4 if not yet acquired)
+        std::atomic<unsigned int> published{0};               // number of published snapshots
+        int back = 0;                                         // buffer written by the simulation thread
+        int front = 2;                                        // buffer read by the render thread
+    };
+
+    // Heightfield texture output
+    struct HeightfieldTexture {
+        static const int block = 16;  // block size (texels) for dirty rectangles
+        int width = 0;                // number of texel columns (0 if not yet created)
+        int height = 0;               // number of texel rows
+        std::vector<float> heights;   // height texture
+        std::vector<float> values;    // scalar texture (current plot quantity)
+        std::vector<int> texels;      // modified texels (each listed once)
+        std::vector<bool> dirty;      // per-texel flags (texel already in list?)
+        std::vector<bool> blocks;     // per-block flags (block modified since last query?)
+    };
+
+    // Coarse traversability map
+    struct TraversabilityMap {
+        double cell_size = 0;                                  // requested cell size
+        int cell_nodes = 0;                                    // number of grid nodes per cell side
+        int width = 0;                                         // number of cell columns (0 if not yet created)
+        int height = 0;                                        // number of cell rows
+        std::vector<SCMTerrainOld::TraversabilityCell> cells;  // map cells
+        std::vector<int> modified;                             // modified cells (each listed once)
+        std::vector<bool> dirty;                               // per-cell flags (cell already in list?)
+        std::vector<double> levels;                            // scratch node levels for one cell
+    };
+
+    // Header of a binary checkpoint file (followed by the node records and the lists of grid locations)
+    struct CheckpointHeader {
+        static const std::uint32_t current_version = 2;
+        char magic[8];                           // file signature ("SCMCKPT")
+        std::uint32_t version;                   // file format version
+        std::uint32_t header_size;               // size of this header (offset of node records)
+        std::uint32_t incremental;               // incremental checkpoint?
+        std::uint32_t sequence;                  // position in checkpoint chain (0 for a full checkpoint)
+        std::uint64_t chain;                     // checkpoint chain identifier
+        std::int32_t type;                       // patch type
+        std::int32_t nx;                         // range for grid indices in X direction
+        std::int32_t ny;                         // range for grid indices in Y direction
+        std::int32_t bulldozing;                 // bulldozing enabled?
+        double delta;                            // grid spacing
+        double soil[8];                          // SCM soil parameters
+        double flow_factor;                      // bulldozing parameters
+        double erosion_slope;                    //
+        std::int32_t erosion_iterations;         //
+        std::int32_t erosion_propagations;       //
+        std::int32_t bulldozing_interval;        //
+        std::int32_t bulldozing_counter;         //
+        std::int32_t job_pending;                // uncollected bulldozing job?
+        std::int32_t job_num_erosion_nodes;      //
+        double job_displaced;                    //
+        double job_deposited;                    //
+        double stats[5];                         // aggregate deformation statistics
+        std::int64_t stats_num_touched_nodes;    //
+        std::uint64_t num_nodes;                 // number of node records
+        std::uint64_t num_locations[5];          // number of grid locations in each list
+    };
+
+    // Node record in a binary checkpoint file
+    struct CheckpointNode {
+        std::int32_t i;
+        std::int32_t j;
+        double level_initial;
+        double level;
+        double hit_level;
+        double normal[3];
+        double sinkage;
+        double sinkage_plastic;
+        double sinkage_elastic;
+        double sigma;
+        double sigma_yield;
+        double kshear;
+        double tau;
+        double massremainder;
+        double step_plastic_flow;
+        std::int32_t erosion;
+        std::int32_t erosion_hops;
+    };
+
+    // Node data in a snapshot of the terrain state
+    struct SnapshotNode {
+        double level;            // node level (relative to SCM frame)
+        double sinkage;          // along local normal direction
+        double sinkage_plastic;  // along local normal direction
+        double sinkage_elastic;  // along local normal direction
+        double sigma;            // along local normal direction
+        double sigma_yield;      // along local normal direction
+        double kshear;           // along local tangent direction
+        double tau;              // along local tangent direction
+    };
+
+    // Snapshot of the terrain state (one of a ring of snapshots, updated incrementally by the simulation thread)
+    struct StateSnapshot {
+        std::unordered_map<ChVector2i, SnapshotNode, CoordHash> nodes;  // modified grid nodes
+        std::vector<ChVector2i> pending;                                // nodes modified since last snapshot update
+        std::atomic<int> readers{0};                                    // number of active readers
+        unsigned int epoch = 0;                                         // snapshot sequence number
+    };
+
+    // Accessors to grid node records used during bulldozing
+    class GridDirect;   // direct access to the grid map
+    class GridOverlay;  // copy-on-access overlay (deferred bulldozing)
+
+    // Read-only view of a checkpoint file
+    class CheckpointFile;
+
+    // Header of a deformation log file (followed by the recorded frames)
+    struct RecordingHeader {
+        static const std::uint32_t current_version = 1;
+        char magic[8];                   // file signature ("SCMRLOG")
+        std::uint32_t version;           // file format version
+        std::uint32_t header_size;       // size of this header (offset of first frame)
+        std::int32_t type;               // patch type
+        std::int32_t nx;                 // range for grid indices in X direction
+        std::int32_t ny;                 // range for grid indices in Y direction
+        std::int32_t keyframe_interval;  // number of steps between keyframes
+        double delta;                    // grid spacing
+        double resolution;               // level quantization step
+    };
+
+    // Header of a recorded frame in a deformation log file (followed by the encoded node levels)
+    struct RecordingFrame {
+        std::uint64_t step;      // SCM step (since the start of recording)
+        double time;             // simulation time
+        std::uint32_t keyframe;  // all nodes (keyframe) or nodes modified over the step?
+        std::uint32_t size;      // size of encoded node levels
+    };
+
+    // Recorder of the terrain deformation (frames queued in a single-producer single-consumer ring buffer and written
+    // to the log file by a background thread)
+    struct DeformationRecorder {
+        struct Frame {
+            RecordingFrame info;             // frame header
+            std::vector<std::uint8_t> data;  // encoded node levels (buffer reused across frames)
+        };
+        FILE* file = nullptr;                // log file
+        double resolution = 0;               // level quantization step
+        int keyframe_interval = 1;           // number of steps between keyframes
+        bool force_keyframe = true;          // record a keyframe at the next step?
+        std::uint64_t step = 0;              // number of recorded steps
+        std::vector<Frame> ring;             // ring buffer of frames
+        std::atomic<std::uint64_t> head{0};  // number of frames queued by the simulation thread
+        std::atomic<std::uint64_t> tail{0};  // number of frames written by the background thread
+        std::atomic<bool> stop{false};       // stop the background thread once all frames are written?
+        bool failed = false;                 // error in writing the log file (background thread only)?
+        std::thread writer;                  // background writer thread
+    };
+
+    // Domain decomposition of the grid across processes, with data exchanged through a shared-memory segment (see
+    // SCMTerrainOld::SetDomainDecomposition). The segment holds a header, followed by one slot per subdomain for each
+    // step parity (published ghost node records, partial forces on shared bodies, and material sent to the owners of
+    // ghost nodes).
+    struct DomainDecomposition {
+        std::string name;                         // name of the shared-memory segment
+        int num_x = 1;                            // number of subdomains in X direction
+        int num_y = 1;                            // number of subdomains in Y direction
+        int rank = 0;                             // subdomain owned by this process
+        int halo = 0;                             // width of the ghost layer (grid nodes)
+        int max_bodies = 0;                       // number of shared body slots
+        ChVector2i own_min;                       // first grid node owned by this process
+        ChVector2i own_max;                       // last grid node owned by this process
+        ChVector2i local_min;                     // first grid node of owned range extended by the ghost layer
+        ChVector2i local_max;                     // last grid node of owned range extended by the ghost layer
+        std::unordered_map<ChBody*, int> bodies;  // shared bodies and their identifiers
+        size_t halo_capacity = 0;                 // maximum number of node records in a slot
+        size_t raise_capacity = 0;                // maximum number of material transfers in a slot
+        size_t slot_size = 0;                     // size of a subdomain slot
+        std::uint64_t step = 0;                   // number of completed exchanges
+        char* segment = nullptr;                  // mapped shared-memory segment
+        size_t segment_size = 0;                  // size of the shared-memory segment
+        std::vector<CheckpointNode> ghosts;       // node records received from other subdomains, not yet applied
+        std::vector<ChVector2i> published;        // owned nodes modified and published at the last exchange
+        std::vector<ChVector2i> applied;          // nodes modified by received data, not yet reported as modified
+
+        // Material received from other subdomains for owned nodes (grid node, amount), not yet applied
+        std::vector<std::pair<ChVector2i, double>> received;
+
+        // Material added by bulldozing to ghost nodes (grid node, amount), sent to their owners at the next exchange
+        std::vector<std::pair<ChVector2i, double>> raised;
+    };
+
     // Create visualization mesh
     void CreateVisualizationMesh(double sizeX, double sizeY);
 
+    // Create the tiles of the visualization mesh (tiled level-of-detail mode).
+    void CreateMeshTiles();
+
+    // Build the specified visualization mesh tile at the given level of detail.
+    void BuildMeshTile(MeshTile& tile, int lod);
+
     // Get the initial undeformed terrain height (relative to the SCM plane) at the specified grid node.
     double GetInitHeight(const ChVector2i& loc) const;
 
@@ -491,18 +1197,34 @@ class CH_VEHICLE_API SCMLoaderOld : public ChLoadContainer {
     // Get the terrain normal (expressed in World frame) at the point below the specified location.
     ChVector3d GetNormal(const ChVector3d& loc) const;
 
+    // Get the terrain heights (and optionally normals), expressed in World frame, below 'n' specified locations.
+    // Heights are bilinearly interpolated over grid cells; normals are evaluated from the interpolated height field.
+    // The query reuses scratch buffers of the loader and must not be called concurrently.
+    void GetHeights(const ChVector3d* locs, size_t n, double* heights, ChVector3d* normals) const;
+
     // Get index of trimesh vertex corresponding to the specified grid node.
     int GetMeshVertexIndex(const ChVector2i& loc);
 
-    // Get indices of trimesh faces incident to the specified grid vertex.
-    std::vector<int> GetMeshFaceIndices(const ChVector2i& loc);
-
     // Check if the provided grid location is within the visualization mesh bounds
     bool CheckMeshBounds(const ChVector2i& loc) const;
 
     // Return information at node closest to specified location.
     SCMTerrainOld::NodeInfo GetNodeInfo(const ChVector3d& loc) const;
 
+    // Export SCM information at all grid nodes in a rectangular window.
+    void ExportNodeInfo(const ChVector2i& start,
+                        int width,
+                        int height,
+                        const SCMTerrainOld::NodeInfoBuffers& buffers) const;
+
+    // Write the values of a node quantity over the entire patch as a raw raster file.
+    void WriteRaster(const std::string& filename,
+                     SCMTerrainOld::DataPlotType field,
+                     SCMTerrainOld::RasterFormat format) const;
+
+    // Save the visualization mesh (all tiles, if tiled) to a file in the specified format.
+    void WriteMesh(const std::string& filename, SCMTerrainOld::MeshFormat format) const;
+
     // Complete setup before first simulation step.
     virtual void SetupInitial() override;
 
@@ -518,8 +1240,18 @@ class CH_VEHICLE_API SCMLoaderOld : public ChLoadContainer {
         // this is a problem because in this force model the force is dissipative and keeps a 'history'.
         // Instead, we invoke ComputeInternalForces only at the beginning of the timestep in Setup().
         ChPhysicsItem::Update(time, update_assets);
+
+        // Flush pending changes to the visualization mesh at most once per update interval.
+        // Update may be called with decreasing times (within a step, or when the simulation is restarted).
+        if (update_assets && std::abs(time - m_vis_update_time) >= m_vis_update_interval) {
+            m_vis_update_time = time;
+            UpdateVisualization();
+        }
     }
 
+    // Update the visualization mesh at all grid nodes modified since the last update.
+    void UpdateVisualization();
+
     // Synchronize information for a user-provided active domain.
     void UpdateActiveDomain(ActiveDomainInfo& ad, const ChVector3d& Z);
 
@@ -527,7 +1259,7 @@ class CH_VEHICLE_API SCMLoaderOld : public ChLoadContainer {
     void UpdateDefaultActiveDomain(ActiveDomainInfo& ad);
 
     // Ray-OBB intersection test
-    bool RayOBBtest(const ActiveDomainInfo& ad, const ChVector3d& from, const ChVector3d& Z);
+    bool RayOBBtest(const ActiveDomainInfo& ad, const ChVector3d& from);
 
     // Reset the list of forces and fill it with forces from the soil contact model.
     // This is called automatically during timestepping (only at the beginning of each step).
@@ -541,26 +1273,217 @@ class CH_VEHICLE_API SCMLoaderOld : public ChLoadContainer {
         ChLoadContainer::IntLoadResidual_F(off, R, c);
     }
 
-    // Add specified amount of material (possibly clamped) to node.
-    void AddMaterialToNode(double amount, NodeRecord& nr);
+    // Add specified amount of material (possibly clamped) to node. Return the change in node level.
+    double AddMaterialToNode(double amount, NodeRecord& nr);
+
+    // Remove specified amount of material (possibly clamped) from node. Return the decrease in node level.
+    double RemoveMaterialFromNode(double amount, NodeRecord& nr);
+
+    // Flow material to the side of ruts (bulldozing effects), accessing node records through the given grid.
+    // If 'erosion = false', only the contact patch boundaries are raised.
+    template <class Grid>
+    void DoBulldozing(Grid& grid, BulldozingJob& job, bool erosion);
+
+    // Incrementally update the erosion domain of the job, given the current contact patch boundaries and touched
+    // nodes. Only nodes whose distance to the patch boundaries changed since the previous step are visited.
+    template <class Grid>
+    void UpdateErosionDomain(Grid& grid, BulldozingJob& job, const NodeSet& boundary, const NodeSet& touched);
+
+    // Exchange the erosion domain state between the loader and the bulldozing job.
+    void SwapErosionDomain(BulldozingJob& job);
+
+    // Discard the current erosion domain (forces a complete rebuild at the next bulldozing step).
+    void ResetErosionDomain();
+
+    // Perform bulldozing for the given contact patches (immediately or as a deferred job).
+    void StartBulldozing(std::vector<std::vector<ChVector2i>>&& patches, bool erosion);
+
+    // Wait for a deferred bulldozing job (if any) and merge its results into the grid map.
+    void WaitBulldozing();
+
+    // Collect the modified nodes and statistics of the last completed bulldozing job.
+    void FinishBulldozing();
+
+    // Flag the given grid node for the next visualization update (mesh vertex and heightfield texel) and for the next
+    // update of the traversability map.
+    void MarkVisualizationNode(const ChVector2i& ij);
+
+    // Flag the traversability map cells affected by the given grid node.
+    void MarkTraversabilityNode(const ChVector2i& ij);
 
-    // Remove specified amount of material (possibly clamped) from node.
-    void RemoveMaterialFromNode(double amount, NodeRecord& nr);
+    // Flag the visualization mesh vertex at the given grid node (if any) for the next visualization update.
+    void MarkMeshVertex(const ChVector2i& ij);
 
-    // Update vertex position and color in visualization mesh
-    void UpdateMeshVertexCoordinates(const ChVector2i ij, int iv, const NodeRecord& nr);
+    // Flag the mesh tile vertices at the given grid node for the next visualization update.
+    void MarkMeshTileVertex(const ChVector2i& ij);
 
-    // Update vertex normal in visualization mesh
-    void UpdateMeshVertexNormal(const ChVector2i ij, int iv);
+    // Update the (single) visualization mesh at all modified vertices.
+    void UpdateMesh();
+
+    // Select the level of detail of all mesh tiles and update their modified vertices.
+    void UpdateMeshTiles();
+
+    // Update the heightfield textures at all modified texels.
+    void UpdateHeightfield();
+
+    // Update the traversability map at all modified cells (the map is a cache, see m_traversability).
+    void UpdateTraversabilityMap() const;
+
+    // Recompute the summary of the given traversability map cell.
+    void UpdateTraversabilityCell(int ic) const;
+
+    // Return the value of the current plot quantity (or of the specified plot quantity) at the given node.
+    double GetPlotValue(const NodeRecord& nr) const;
+    static double GetPlotValue(const NodeRecord& nr, SCMTerrainOld::DataPlotType type);
+
+    // Copy the given modified vertices (sorted, unique) into the back snapshot buffer and publish it.
+    void PublishMeshSnapshot(const std::vector<int>& modified);
+
+    // Record the given grid nodes as modified in all state snapshots.
+    void MarkSnapshotNodes(const std::vector<ChVector2i>& nodes);
+
+    // Bring the oldest state snapshot up to date and make it current.
+    void PublishStateSnapshot();
+
+    // Get the terrain height (relative to the SCM plane) at the specified grid node, from the given state snapshot.
+    double GetSnapshotHeight(const StateSnapshot& snap, const ChVector2i& loc) const;
+
+    // Update vertex position in visualization mesh
+    void UpdateMeshVertexCoordinates(ChTriangleMeshConnected& trimesh,
+                                     const ChVector2i ij,
+                                     int iv,
+                                     const NodeRecord& nr);
+
+    // Update vertex colors in visualization mesh, given the node records at the specified vertices.
+    void UpdateMeshVertexColors(ChTriangleMeshConnected& trimesh,
+                                const std::vector<int>& vertices,
+                                const std::vector<const NodeRecord*>& records);
+
+    // Build the colormap lookup table for the current plot type, range, and colormap.
+    void UpdateColormapLUT();
+
+    // Update normals of the 'ni' x 'nj' vertices, starting at column 'i0' and row 'j0', of a visualization mesh grid
+    // with 'nvx' x 'nvy' vertices.
+    void UpdateMeshVertexNormals(ChTriangleMeshConnected& trimesh, int nvx, int nvy, int i0, int j0, int ni, int nj);
+
+    // Update normals at the given vertices (sorted, unique) of a visualization mesh grid with 'nvx' x 'nvy' vertices.
+    void UpdateMeshNormals(ChTriangleMeshConnected& trimesh, int nvx, int nvy, const std::vector<int>& vertices);
 
     /// Get the heights of all modified grid nodes.
     /// If 'all_nodes = true', return modified nodes from the start of simulation.  Otherwise, return only the nodes
     /// modified over the last step.
     std::vector<SCMTerrainOld::NodeLevel> GetModifiedNodes(bool all_nodes = false) const;
 
+    // Visit the heights of all modified grid nodes (see SCMTerrainOld::VisitModifiedNodes).
+    template <typename Visitor>
+    void VisitModifiedNodes(Visitor visitor, bool all_nodes) const;
+
+    // Remove duplicate entries from the list of nodes modified over the last step (sorting it row after row).
+    void UniqueModifiedNodes();
+
+    // Reset all grid nodes to the undeformed terrain (updating the visualization outputs) and clear the grid map and
+    // spatial index. The locations of the reset nodes are appended to 'nodes'.
+    void ClearGridMap(std::vector<ChVector2i>& nodes);
+
+    // Start and stop recording the terrain deformation.
+    void StartRecording(const std::string& filename, int keyframe_interval, double resolution, int buffer_frames);
+    void StopRecording();
+
+    // Record the grid nodes modified over the current step.
+    void RecordStep();
+
+    // Apply a recorded frame (node levels in the compact delta format); a keyframe replaces all grid nodes.
+    void ApplyRecordedFrame(const std::uint8_t* data, size_t size, bool keyframe);
+
+    // Visit all grid map nodes in the given grid index range, using the spatial index.
+    template <typename Visitor>
+    void VisitIndexedNodes(const ChVector2i& min, const ChVector2i& max, Visitor visitor) const;
+
+    // Get the heights of modified grid nodes in the given grid index range and accepted by the specified filter.
+    template <typename Filter>
+    std::vector<SCMTerrainOld::NodeLevel> GetModifiedNodes(const ChVector2i& min,
+                                                           const ChVector2i& max,
+                                                           Filter filter,
+                                                           bool all_nodes) const;
+
+    // Add a new grid map node to the spatial index.
+    void IndexNode(const ChVector2i& ij);
+
     // Modify the level of grid nodes from the given list.
     void SetModifiedNodes(const std::vector<SCMTerrainOld::NodeLevel>& nodes);
 
+    // Modify the level of grid nodes provided by the given source.
+    template <typename NodeSource>
+    void SetNodeLevels(NodeSource source);
+
+    // Apply a sorted batch of grid node updates, preserving the deformation history of the nodes.
+    void ApplyNodeUpdates(const std::vector<SCMTerrainOld::NodeUpdate>& updates, int fields);
+
+    // Encode the heights of modified grid nodes in the compact delta format.
+    void EncodeModifiedNodes(std::vector<std::uint8_t>& buffer, double resolution, bool all_nodes) const;
+
+    // Decode grid node heights in the compact delta format, passing each (grid node, level) to the given visitor.
+    template <typename Visitor>
+    void DecodeModifiedNodes(const std::uint8_t* data, size_t size, Visitor visitor) const;
+
+    // Write a binary checkpoint of the complete SCM state.
+    void WriteCheckpoint(const std::string& filename);
+
+    // Write an incremental checkpoint (node records in tiles modified since the previous checkpoint).
+    void WriteCheckpointDelta(const std::string& filename);
+
+    // Restore the SCM state from a checkpoint chain (full checkpoint followed by consecutive deltas).
+    void ReadCheckpoint(const std::vector<std::string>& filenames);
+
+    // Merge a checkpoint chain into a single full checkpoint.
+    static void CompactCheckpoints(const std::vector<std::string>& filenames, const std::string& filename);
+
+    // Fill the header of a checkpoint of the current state (parameters, bulldozing state, statistics, list sizes).
+    void FillCheckpointHeader(CheckpointHeader& hdr, const std::vector<ChVector2i>* lists[5]) const;
+
+    // Write a checkpoint file with the given header, node records (provided in blocks by 'nodes'), and location lists.
+    template <typename NodeSource>
+    static void WriteCheckpointFile(const std::string& filename,
+                                    const CheckpointHeader& hdr,
+                                    NodeSource nodes,
+                                    const std::vector<ChVector2i>* const lists[5]);
+
+    // Conversion between node records and checkpoint node records.
+    static CheckpointNode PackCheckpointNode(const ChVector2i& ij, const NodeRecord& nr);
+    static void UnpackCheckpointNode(const CheckpointNode& cn, NodeRecord& nr);
+
+    // Open the given checkpoint chain and check its consistency.
+    static std::vector<std::unique_ptr<CheckpointFile>> OpenCheckpointChain(const std::vector<std::string>& filenames);
+
+    // Start tracking the tiles modified after a checkpoint of the given chain.
+    void ResetCheckpointTracking(std::uint64_t chain, std::uint32_t sequence);
+
+    // Flag the tile containing the given grid node as modified since the last checkpoint.
+    void MarkCheckpointNode(const ChVector2i& ij);
+
+    // Split the grid into subdomains and attach to the shared-memory segment (waits for all processes).
+    void SetDomainDecomposition(const std::string& name, int num_x, int num_y, int rank, int halo, int max_bodies);
+
+    // Detach from the shared-memory segment of the domain decomposition.
+    void CloseDomainDecomposition();
+
+    // Get the range of grid indices owned by the given subdomain.
+    void GetSubdomainRange(int rank, ChVector2i& min, ChVector2i& max) const;
+
+    // Get the subdomain containing the given grid node (clamped to the grid).
+    int GetSubdomain(const ChVector2i& ij) const;
+
+    // Wait until all processes of the domain decomposition reach this point.
+    void SubdomainBarrier();
+
+    // Publish the owned nodes modified over this step within the ghost layer of other subdomains and the partial
+    // forces on shared bodies, then apply the ghost nodes received from other subdomains and reduce the forces on
+    // the shared bodies owned by this process.
+    void ExchangeSubdomains();
+
+    // Apply the ghost nodes and the material received from other subdomains (deferred while a bulldozing job runs).
+    void ApplySubdomainExchange();
+
     PatchType m_type;      ///< type of SCM patch
     ChCoordsys<> m_frame;  ///< SCM frame (deformation occurs along the z axis of this frame)
     ChVector3d m_Z;        ///< SCM plane vertical direction (in absolute frame)
@@ -587,6 +1510,9 @@ class CH_VEHICLE_API SCMLoaderOld : public ChLoadContainer {
     std::shared_ptr<ChVisualShapeTriangleMesh> m_trimesh_shape;  ///< mesh visualization asset
     std::unique_ptr<ChColormap> m_colormap;                      ///< colormap for mesh false coloring
     ChColormap::Type m_colormap_type;                            ///< colormap type
+    std::vector<ChColor> m_colormap_lut;                         ///< colormap lookup table (empty if outdated)
+    double m_colormap_lut_offset;                                ///< plot value at lower end of first table entry
+    double m_colormap_lut_scale;                                 ///< number of table entries per unit plot value
 
     bool m_cosim_mode;  ///< co-simulation mode
 
@@ -613,14 +1539,75 @@ class CH_VEHICLE_API SCMLoaderOld : public ChLoadContainer {
     double m_erosion_slope;
     int m_erosion_iterations;
     int m_erosion_propagations;
+    NodeSet m_erosion_domain;               ///< nodes in current erosion domain (persistent across steps)
+    NodeSet m_erosion_boundary;             ///< union of contact patch boundaries at last erosion step
+    NodeSet m_erosion_touched;              ///< touched nodes in contact patches at last erosion step
+    int m_bulldozing_interval;              ///< number of SCM steps between erosion evaluations
+    int m_bulldozing_counter;               ///< number of SCM steps since last erosion evaluation
+    bool m_bulldozing_async;                ///< perform erosion on a background thread?
+    BulldozingJob m_bulldozing_job;         ///< current bulldozing job
+    std::future<void> m_bulldozing_future;  ///< deferred bulldozing job
 
     // Mesh coloring mode
     SCMTerrainOld::DataPlotType m_plot_type;
     double m_plot_v_min;
     double m_plot_v_max;
 
-    // Indices of visualization mesh vertices modified externally
-    std::vector<int> m_external_modified_vertices;
+    // Lazy update of the visualization assets
+    double m_vis_update_interval;  ///< minimum simulation time between updates from the asset update
+    double m_vis_update_time;      ///< simulation time of the last update from the asset update
+
+    // Visualization mesh vertices modified since last update of the visualization mesh
+    std::vector<int> m_vis_vertices;  ///< indices of modified mesh vertices (each listed once)
+    std::vector<bool> m_vis_dirty;    ///< per-vertex flags (vertex already in list?)
+
+    // Scratch buffer for face normals (two rows of mesh cells, for the normal update of a rectangle of mesh vertices)
+    std::vector<ChVector3d> m_vis_face_normals;
+
+    // Scratch buffers for mesh coloring (node records and plot values at updated vertices)
+    std::vector<const NodeRecord*> m_vis_records;
+    std::vector<float> m_vis_values;
+
+    // Tiled level-of-detail visualization mesh
+    int m_tile_size;                     ///< number of grid cells on the side of a mesh tile (0: no tiling)
+    int m_tile_lods;                     ///< number of levels of detail
+    double m_tile_lod_distance;          ///< distance between consecutive levels of detail
+    ChVector3d m_tile_lod_reference;     ///< reference point for level of detail selection
+    int m_ntx;                           ///< number of mesh tiles in X direction
+    int m_nty;                           ///< number of mesh tiles in Y direction
+    std::vector<MeshTile> m_mesh_tiles;  ///< visualization mesh tiles
+
+    // Snapshots of the visualization mesh (null if disabled; set and loaded atomically, shared with the render thread)
+    std::shared_ptr<MeshSnapshots> m_vis_snapshots;
+
+    // Heightfield texture output (null if disabled)
+    std::unique_ptr<HeightfieldTexture> m_heightfield;
+
+    // Coarse traversability map (null if disabled).
+    // Modified cells are only flagged during the step; the map is a cache of the grid state brought up to date by the
+    // (const) queries, hence mutable.
+    mutable std::unique_ptr<TraversabilityMap> m_traversability;
+
+    // Scratch buffers of the batched height queries (reused across queries, hence mutable)
+    mutable std::vector<double> m_query_values;           ///< per-location values (8 arrays of n values)
+    mutable std::vector<ChVector2i> m_query_cells;        ///< grid cells enclosing the query locations
+    mutable std::vector<ChVector2i> m_query_cache_nodes;  ///< grid nodes in the height cache
+    mutable std::vector<double> m_query_cache_heights;    ///< heights in the height cache
+
+    // Recorder of the terrain deformation (null if not recording)
+    std::unique_ptr<DeformationRecorder> m_recorder;
+
+    // Domain decomposition across processes (null if disabled)
+    std::unique_ptr<DomainDecomposition> m_decomposition;
+
+    // Spatial index of grid map nodes (node locations binned in square buckets of index_bucket x index_bucket nodes)
+    static const int index_bucket = 32;
+    std::unordered_map<ChVector2i, std::vector<ChVector2i>, CoordHash> m_node_index;
+
+    // Snapshots of the terrain state for concurrent queries
+    bool m_state_snapshots;                  ///< state snapshots enabled?
+    StateSnapshot m_snapshots[3];            ///< ring of state snapshots
+    std::atomic<int> m_snapshot_current{0};  ///< index of current state snapshot
 
     // Timers and counters
     ChTimer m_timer_active_domains;
@@ -633,15 +1620,44 @@ class CH_VEHICLE_API SCMLoaderOld : public ChLoadContainer {
     ChTimer m_timer_bulldozing_domain;
     ChTimer m_timer_bulldozing_erosion;
     ChTimer m_timer_visualization;
+    ChTimer m_timer_subdomain_exchange;
     int m_num_ray_casts;
     int m_num_ray_hits;
     int m_num_contact_patches;
     int m_num_erosion_nodes;
 
+    SCMTerrainOld::DeformationStats m_stats;  ///< running aggregate statistics
+
+    // Tiles (spatial index buckets) modified since the last checkpoint, for incremental checkpoints
+    std::uint64_t m_ckpt_chain;             ///< current checkpoint chain
+    std::uint32_t m_ckpt_sequence;          ///< position of last checkpoint in current chain
+    ChVector2i m_ckpt_origin;               ///< first tile covering the patch
+    int m_ckpt_ntx;                         ///< number of tiles covering the patch in X direction
+    int m_ckpt_nty;                         ///< number of tiles covering the patch in Y direction
+    std::vector<bool> m_ckpt_dirty;         ///< per-tile flags (empty if not tracking)
+    std::vector<ChVector2i> m_ckpt_tiles;   ///< modified tiles covering the patch (each listed once)
+    NodeSet m_ckpt_outside;                 ///< modified tiles outside the patch
+
     friend class SCMTerrainOld;
     friend class ChScmVisualizationVSG;
 };
 
+template <typename Visitor>
+void SCMTerrainOld::VisitModifiedNodes(Visitor visitor, bool all_nodes) const {
+    m_loader->VisitModifiedNodes(visitor, all_nodes);
+}
+
+template <typename Visitor>
+void SCMLoaderOld::VisitModifiedNodes(Visitor visitor, bool all_nodes) const {
+    if (all_nodes) {
+        for (const auto& nr : m_grid_map)
+            visitor(nr.first, nr.second.level);
+    } else {
+        for (const auto& ij : m_modified_nodes)
+            visitor(ij, m_grid_map.at(ij).level);
+    }
+}
+
 /// @} vehicle_terrain
 
 }  // end namespace vehicle
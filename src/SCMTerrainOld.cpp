@@ -22,11 +22,27 @@
 #include <queue>
 #include <unordered_set>
 #include <limits>
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <cstring>
+#include <random>
+#include <chrono>
+#include <cerrno>
+#include <iterator>
 
 #ifdef _OPENMP
     #include <omp.h>
 #endif
 
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <signal.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
 #include "chrono/physics/ChContactMaterialNSC.h"
 #include "chrono/physics/ChContactMaterialSMC.h"
 #include "chrono/fea/ChContactSurfaceMesh.h"
@@ -36,7 +52,7 @@
 #include "chrono/utils/ChUtils.h"
 
 #include "chrono_vehicle/ChVehicleModelData.h"
-#include "chrono_vehicle/terrain/SCMTerrain.h"
+#include "chrono_gpu_scm/SCMTerrainOld.h"
 
 #include "chrono_thirdparty/stb/stb.h"
 
@@ -78,6 +94,21 @@ ChVector3d SCMTerrainOld::GetNormal(const ChVector3d& loc) const {
     return m_loader->GetNormal(loc);
 }
 
+// Get the terrain heights below the specified locations (batched query).
+void SCMTerrainOld::GetHeights(const std::vector<ChVector3d>& locs, std::vector<double>& heights) const {
+    heights.resize(locs.size());
+    m_loader->GetHeights(locs.data(), locs.size(), heights.data(), nullptr);
+}
+
+// Get the terrain heights and normals below the specified locations (batched query).
+void SCMTerrainOld::GetHeightsAndNormals(const std::vector<ChVector3d>& locs,
+                                         std::vector<double>& heights,
+                                         std::vector<ChVector3d>& normals) const {
+    heights.resize(locs.size());
+    normals.resize(locs.size());
+    m_loader->GetHeights(locs.data(), locs.size(), heights.data(), normals.data());
+}
+
 // Return the terrain coefficient of friction at the specified location.
 float SCMTerrainOld::GetCoefficientFriction(const ChVector3d& loc) const {
     return m_friction_fun ? (*m_friction_fun)(loc) : 0.8f;
@@ -88,6 +119,265 @@ SCMTerrainOld::NodeInfo SCMTerrainOld::GetNodeInfo(const ChVector3d& loc) const
     return m_loader->GetNodeInfo(loc);
 }
 
+// Export SCM information at all grid nodes in a rectangular window.
+void SCMTerrainOld::ExportNodeInfo(const ChVector2i& start,
+                                   int width,
+                                   int height,
+                                   const NodeInfoBuffers& buffers) const {
+    m_loader->ExportNodeInfo(start, width, height, buffers);
+}
+
+// Enable/disable snapshots of the terrain state for concurrent queries.
+void SCMTerrainOld::EnableStateSnapshots(bool val) {
+    auto& loader = *m_loader;
+    if (val == loader.m_state_snapshots)
+        return;
+
+    loader.m_state_snapshots = val;
+    for (auto& snap : loader.m_snapshots) {
+        snap.nodes.clear();
+        snap.pending.clear();
+    }
+
+    // Record all existing grid nodes and publish a first snapshot
+    if (val) {
+        std::vector<ChVector2i> nodes;
+        nodes.reserve(loader.m_grid_map.size());
+        for (const auto& n : loader.m_grid_map)
+            nodes.push_back(n.first);
+        loader.MarkSnapshotNodes(nodes);
+        loader.PublishStateSnapshot();
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+// Acquire the current state snapshot.
+// The reader count of the snapshot is incremented before checking that the snapshot is still current; otherwise, the
+// simulation thread may already be updating it, and the acquisition is retried.
+SCMTerrainOld::StateReader::StateReader(const SCMTerrainOld& terrain) : m_loader(terrain.m_loader), m_snapshot(-1) {
+    if (!m_loader->m_state_snapshots)
+        return;
+
+    while (true) {
+        int s = m_loader->m_snapshot_current.load();
+        m_loader->m_snapshots[s].readers++;
+        if (m_loader->m_snapshot_current.load() == s) {
+            m_snapshot = s;
+            return;
+        }
+        m_loader->m_snapshots[s].readers--;
+    }
+}
+
+// Release the state snapshot.
+SCMTerrainOld::StateReader::~StateReader() {
+    if (m_snapshot >= 0)
+        m_loader->m_snapshots[m_snapshot].readers--;
+}
+
+// Get the terrain height below the specified location (from the state snapshot).
+double SCMTerrainOld::StateReader::GetHeight(const ChVector3d& loc) const {
+    if (m_snapshot < 0)
+        return 0;
+    const auto& loader = *m_loader;
+    const auto& snap = loader.m_snapshots[m_snapshot];
+
+    // Express location in the SCM frame
+    ChVector3d loc_loc = loader.m_frame.TransformPointParentToLocal(loc);
+
+    // Get height (relative to SCM plane) at closest grid vertex (approximation)
+    int i = static_cast<int>(std::round(loc_loc.x() / loader.m_delta));
+    int j = static_cast<int>(std::round(loc_loc.y() / loader.m_delta));
+    loc_loc.z() = loader.GetSnapshotHeight(snap, ChVector2i(i, j));
+
+    // Express in global frame
+    ChVector3d loc_abs = loader.m_frame.TransformPointLocalToParent(loc_loc);
+    return ChWorldFrame::Height(loc_abs);
+}
+
+// Get the terrain normal at the point below the specified location (from the state snapshot).
+ChVector3d SCMTerrainOld::StateReader::GetNormal(const ChVector3d& loc) const {
+    if (m_snapshot < 0)
+        return ChWorldFrame::Vertical();
+    const auto& loader = *m_loader;
+    const auto& snap = loader.m_snapshots[m_snapshot];
+
+    // Express location in the SCM frame
+    ChVector3d loc_loc = loader.m_frame.TransformPointParentToLocal(loc);
+
+    // Get normal (relative to SCM plane) at closest grid vertex (approximation)
+    int i = static_cast<int>(std::round(loc_loc.x() / loader.m_delta));
+    int j = static_cast<int>(std::round(loc_loc.y() / loader.m_delta));
+    ChVector2i ij(i, j);
+    ChVector3d nrm_loc(0, 0, 1);
+    if (loader.m_type == SCMLoaderOld::PatchType::HEIGHT_MAP || loader.m_type == SCMLoaderOld::PatchType::TRI_MESH) {
+        // Average normals of 4 triangular faces incident to given grid node
+        auto hE = loader.GetSnapshotHeight(snap, ij + ChVector2i(1, 0));  // east
+        auto hW = loader.GetSnapshotHeight(snap, ij - ChVector2i(1, 0));  // west
+        auto hN = loader.GetSnapshotHeight(snap, ij + ChVector2i(0, 1));  // north
+        auto hS = loader.GetSnapshotHeight(snap, ij - ChVector2i(0, 1));  // south
+        nrm_loc = ChVector3d(hW - hE, hS - hN, 2 * loader.m_delta).GetNormalized();
+    }
+
+    // Express in global frame
+    auto nrm_abs = loader.m_frame.TransformDirectionLocalToParent(nrm_loc);
+    return ChWorldFrame::FromISO(nrm_abs);
+}
+
+// Get SCM information at the node closest to the specified location (from the state snapshot).
+SCMTerrainOld::NodeInfo SCMTerrainOld::StateReader::GetNodeInfo(const ChVector3d& loc) const {
+    NodeInfo ni;
+    ni.sinkage = 0;
+    ni.sinkage_plastic = 0;
+    ni.sinkage_elastic = 0;
+    ni.sigma = 0;
+    ni.sigma_yield = 0;
+    ni.kshear = 0;
+    ni.tau = 0;
+    if (m_snapshot < 0)
+        return ni;
+    const auto& loader = *m_loader;
+    const auto& snap = loader.m_snapshots[m_snapshot];
+
+    // Express location in the SCM frame
+    ChVector3d loc_loc = loader.m_frame.TransformPointParentToLocal(loc);
+
+    // Find closest grid vertex (approximation)
+    int i = static_cast<int>(std::round(loc_loc.x() / loader.m_delta));
+    int j = static_cast<int>(std::round(loc_loc.y() / loader.m_delta));
+
+    auto p = snap.nodes.find(ChVector2i(i, j));
+    if (p != snap.nodes.end()) {
+        ni.sinkage = p->second.sinkage;
+        ni.sinkage_plastic = p->second.sinkage_plastic;
+        ni.sinkage_elastic = p->second.sinkage_elastic;
+        ni.sigma = p->second.sigma;
+        ni.sigma_yield = p->second.sigma_yield;
+        ni.kshear = p->second.kshear;
+        ni.tau = p->second.tau;
+    }
+    return ni;
+}
+
+// Get the sequence number of the state snapshot.
+unsigned int SCMTerrainOld::StateReader::GetEpoch() const {
+    return m_snapshot < 0 ? 0 : m_loader->m_snapshots[m_snapshot].epoch;
+}
+
+// 64-bit positioning in deformation logs (which can exceed 2 GB, the range of long on some platforms).
+static inline int SeekLog(FILE* file, std::int64_t offset, int origin) {
+#ifdef _WIN32
+    return _fseeki64(file, offset, origin);
+#else
+    return fseeko(file, static_cast<off_t>(offset), origin);
+#endif
+}
+
+static inline std::int64_t TellLog(FILE* file) {
+#ifdef _WIN32
+    return _ftelli64(file);
+#else
+    return static_cast<std::int64_t>(ftello(file));
+#endif
+}
+
+// Open a deformation log and index its frames.
+// A truncated last frame (e.g., from an interrupted recording) is ignored.
+SCMTerrainOld::DeformationReplay::DeformationReplay(SCMTerrainOld& terrain, const std::string& filename)
+    : m_loader(terrain.m_loader), m_frame(-1) {
+    m_file = std::fopen(filename.c_str(), "rb");
+    if (!m_file) {
+        std::cerr << "Error in opening SCM deformation log " << filename << std::endl;
+        throw std::runtime_error("Cannot open SCM deformation log");
+    }
+
+    SCMLoaderOld::RecordingHeader hdr;
+    bool valid = std::fread(&hdr, sizeof(hdr), 1, m_file) == 1 && std::memcmp(hdr.magic, "SCMRLOG", 8) == 0 &&
+                 hdr.version == SCMLoaderOld::RecordingHeader::current_version && hdr.header_size == sizeof(hdr);
+    if (!valid) {
+        std::fclose(m_file);
+        std::cerr << "Invalid SCM deformation log " << filename << std::endl;
+        throw std::runtime_error("Invalid SCM deformation log");
+    }
+    const auto& loader = *m_loader;
+    if (hdr.type != static_cast<std::int32_t>(loader.m_type) || hdr.nx != loader.m_nx || hdr.ny != loader.m_ny ||
+        hdr.delta != loader.m_delta) {
+        std::fclose(m_file);
+        std::cerr << "SCM deformation log " << filename << " does not match the terrain patch" << std::endl;
+        throw std::runtime_error("SCM deformation log does not match the terrain patch");
+    }
+
+    SCMLoaderOld::RecordingFrame frame;
+    while (std::fread(&frame, sizeof(frame), 1, m_file) == 1) {
+        std::int64_t offset = TellLog(m_file);
+        if (SeekLog(m_file, frame.size, SEEK_CUR) != 0 || TellLog(m_file) < offset + frame.size)
+            break;
+        m_frames.push_back({offset, frame.size, frame.time, frame.keyframe != 0});
+    }
+
+    // Seek to the end of the log to detect truncation
+    SeekLog(m_file, 0, SEEK_END);
+    std::int64_t end = TellLog(m_file);
+    while (!m_frames.empty() && m_frames.back().offset + static_cast<std::int64_t>(m_frames.back().size) > end)
+        m_frames.pop_back();
+
+    if (!m_frames.empty() && !m_frames[0].keyframe) {
+        std::fclose(m_file);
+        std::cerr << "Invalid SCM deformation log " << filename << " (missing keyframe)" << std::endl;
+        throw std::runtime_error("Invalid SCM deformation log");
+    }
+}
+
+SCMTerrainOld::DeformationReplay::~DeformationReplay() {
+    std::fclose(m_file);
+}
+
+// Bring the terrain to the state at the specified frame.
+// Frames are applied from the current frame if possible, otherwise from the closest preceding keyframe.
+void SCMTerrainOld::DeformationReplay::Seek(int frame) {
+    if (m_frames.empty())
+        return;
+    frame = std::max(0, std::min(frame, GetNumFrames() - 1));
+    if (frame == m_frame)
+        return;
+
+    int key = frame;
+    while (!m_frames[key].keyframe)
+        key--;
+    int start = (m_frame >= key && m_frame < frame) ? m_frame + 1 : key;
+    for (int f = start; f <= frame; f++)
+        ApplyFrame(f);
+}
+
+// Bring the terrain to the state at the last frame recorded at or before the specified time.
+void SCMTerrainOld::DeformationReplay::SeekTime(double time) {
+    auto f = std::upper_bound(m_frames.begin(), m_frames.end(), time,
+                              [](double t, const FrameInfo& info) { return t < info.time; });
+    Seek(std::max(0, (int)(f - m_frames.begin()) - 1));
+}
+
+// Advance the replay by the specified number of frames.
+bool SCMTerrainOld::DeformationReplay::Advance(int frames) {
+    if (m_frame + frames >= GetNumFrames())
+        return false;
+    Seek(m_frame + frames);
+    return true;
+}
+
+// Read and apply the specified frame.
+void SCMTerrainOld::DeformationReplay::ApplyFrame(int frame) {
+    const auto& info = m_frames[frame];
+    m_buffer.resize(info.size);
+    if (SeekLog(m_file, info.offset, SEEK_SET) != 0 ||
+        std::fread(m_buffer.data(), 1, info.size, m_file) != info.size) {
+        std::cerr << "Error in reading frame " << frame << " of SCM deformation log" << std::endl;
+        throw std::runtime_error("Cannot read SCM deformation log");
+    }
+    m_loader->ApplyRecordedFrame(m_buffer.data(), m_buffer.size(), info.keyframe);
+    m_frame = frame;
+}
+
 // Set the color of the visualization assets.
 void SCMTerrainOld::SetColor(const ChColor& color) {
     if (m_loader->GetVisualModel()) {
@@ -117,22 +407,178 @@ const ChCoordsys<>& SCMTerrainOld::GetReferenceFrame() const {
 void SCMTerrainOld::SetMeshWireframe(bool val) {
     if (m_loader->m_trimesh_shape)
         m_loader->m_trimesh_shape->SetWireframe(val);
+    for (auto& tile : m_loader->m_mesh_tiles)
+        tile.shape->SetWireframe(val);
+}
+
+// Set the minimum interval between updates of the visualization assets.
+void SCMTerrainOld::SetMeshUpdateInterval(double interval) {
+    m_loader->m_vis_update_interval = std::max(interval, 0.0);
 }
 
 // Get the trimesh that defines the ground shape.
 std::shared_ptr<ChVisualShapeTriangleMesh> SCMTerrainOld::GetMesh() const {
+    m_loader->UpdateVisualization();
     return m_loader->m_trimesh_shape;
 }
 
-// Save the visualization mesh as a Wavefront OBJ file.
-void SCMTerrainOld::WriteMesh(const std::string& filename) const {
+// Save the visualization mesh to a file in the specified format.
+void SCMTerrainOld::WriteMesh(const std::string& filename, MeshFormat format) const {
     if (!m_loader->m_trimesh_shape) {
         std::cout << "SCMTerrainOld::WriteMesh  -- visualization mesh not created.";
         return;
     }
-    auto trimesh = m_loader->m_trimesh_shape->GetMesh();
-    std::vector<ChTriangleMeshConnected> meshes = {*trimesh};
-    trimesh->WriteWavefront(filename, meshes);
+    m_loader->UpdateVisualization();
+    m_loader->WriteMesh(filename, format);
+}
+
+// Write the values of a node quantity over the entire patch as a raw raster file.
+void SCMTerrainOld::WriteRaster(const std::string& filename, DataPlotType field, RasterFormat format) const {
+    m_loader->WriteRaster(filename, field, format);
+}
+
+// Split the visualization mesh into tiles with multiple levels of detail.
+// Levels of detail with a node stride larger than the tile size are dropped (the coarsest level, with stride at most
+// tile_size, only keeps the tile corners).
+void SCMTerrainOld::SetMeshTiling(int tile_size, int num_lods, double lod_distance) {
+    tile_size = std::max(tile_size, 1);
+    int max_lods = 1;
+    while (max_lods < 31 && (1 << max_lods) <= tile_size)
+        max_lods++;
+    m_loader->m_tile_size = tile_size;
+    m_loader->m_tile_lods = ChClamp(num_lods, 1, max_lods);
+    m_loader->m_tile_lod_distance = lod_distance;
+}
+
+// Set the reference point for selecting the level of detail of mesh tiles.
+void SCMTerrainOld::SetMeshLODReference(const ChVector3d& point) {
+    m_loader->m_tile_lod_reference = point;
+}
+
+// Get the visualization meshes of all tiles.
+std::vector<std::shared_ptr<ChVisualShapeTriangleMesh>> SCMTerrainOld::GetMeshTiles() const {
+    m_loader->UpdateVisualization();
+    std::vector<std::shared_ptr<ChVisualShapeTriangleMesh>> shapes;
+    for (const auto& tile : m_loader->m_mesh_tiles)
+        shapes.push_back(tile.shape);
+    return shapes;
+}
+
+// Enable/disable publication of the visualization mesh through triple-buffered snapshots.
+// The snapshot buffers are shared with the render thread, which loads them atomically. When disabled, they are released
+// by the last of the simulation and render threads to drop them, so that a concurrent acquisition remains valid.
+void SCMTerrainOld::SetMeshSnapshots(bool val) {
+    if (!val)
+        std::atomic_store(&m_loader->m_vis_snapshots, std::shared_ptr<SCMLoaderOld::MeshSnapshots>());
+    else if (!m_loader->m_vis_snapshots)
+        std::atomic_store(&m_loader->m_vis_snapshots, chrono_types::make_shared<SCMLoaderOld::MeshSnapshots>());
+}
+
+// Acquire the most recently published snapshot of the visualization mesh (render thread).
+std::shared_ptr<const ChTriangleMeshConnected> SCMTerrainOld::AcquireMeshSnapshot() {
+    auto snap = std::atomic_load(&m_loader->m_vis_snapshots);
+    if (!snap || snap->published.load() == 0)
+        return nullptr;
+
+    // Swap the front buffer with the last published one, if not already acquired
+    if (snap->ready.load() & 4)
+        snap->front = snap->ready.exchange(snap->front) & 3;
+
+    return snap->buffers[snap->front];
+}
+
+// Enable/disable heightfield texture output.
+void SCMTerrainOld::EnableHeightfieldTexture(bool val) {
+    if (!val)
+        m_loader->m_heightfield.reset();
+    else if (!m_loader->m_heightfield)
+        m_loader->m_heightfield = chrono_types::make_unique<SCMLoaderOld::HeightfieldTexture>();
+}
+
+int SCMTerrainOld::GetTextureWidth() const {
+    m_loader->UpdateVisualization();
+    return m_loader->m_heightfield ? m_loader->m_heightfield->width : 0;
+}
+
+int SCMTerrainOld::GetTextureHeight() const {
+    m_loader->UpdateVisualization();
+    return m_loader->m_heightfield ? m_loader->m_heightfield->height : 0;
+}
+
+const std::vector<float>& SCMTerrainOld::GetHeightTexture() const {
+    static const std::vector<float> empty;
+    m_loader->UpdateVisualization();
+    return m_loader->m_heightfield ? m_loader->m_heightfield->heights : empty;
+}
+
+const std::vector<float>& SCMTerrainOld::GetScalarTexture() const {
+    static const std::vector<float> empty;
+    m_loader->UpdateVisualization();
+    return m_loader->m_heightfield ? m_loader->m_heightfield->values : empty;
+}
+
+// Get the rectangles of the heightfield textures modified since the last call.
+// Modified texels are tracked in square blocks; each row of consecutive modified blocks yields one rectangle.
+std::vector<SCMTerrainOld::TextureRect> SCMTerrainOld::GetTextureDirtyRects() {
+    std::vector<TextureRect> rects;
+    if (!m_loader->m_heightfield)
+        return rects;
+
+    m_loader->UpdateVisualization();
+
+    auto& hf = *m_loader->m_heightfield;
+    const int block = SCMLoaderOld::HeightfieldTexture::block;
+    int nbx = (hf.width + block - 1) / block;
+    int nby = (hf.height + block - 1) / block;
+    for (int by = 0; by < nby; by++) {
+        int bx = 0;
+        while (bx < nbx) {
+            if (!hf.blocks[bx + nbx * by]) {
+                bx++;
+                continue;
+            }
+            int bx0 = bx;
+            while (bx < nbx && hf.blocks[bx + nbx * by]) {
+                hf.blocks[bx + nbx * by] = false;
+                bx++;
+            }
+            int x = bx0 * block;
+            int y = by * block;
+            rects.push_back({x, y, std::min(bx * block, hf.width) - x, std::min(y + block, hf.height) - y});
+        }
+    }
+
+    return rects;
+}
+
+// Enable/disable the coarse traversability map.
+void SCMTerrainOld::EnableTraversabilityMap(bool val, double cell_size) {
+    m_loader->m_traversability.reset();
+    if (val) {
+        m_loader->m_traversability = chrono_types::make_unique<SCMLoaderOld::TraversabilityMap>();
+        m_loader->m_traversability->cell_size = cell_size;
+    }
+}
+
+int SCMTerrainOld::GetTraversabilityMapWidth() const {
+    m_loader->UpdateTraversabilityMap();
+    return m_loader->m_traversability ? m_loader->m_traversability->width : 0;
+}
+
+int SCMTerrainOld::GetTraversabilityMapHeight() const {
+    m_loader->UpdateTraversabilityMap();
+    return m_loader->m_traversability ? m_loader->m_traversability->height : 0;
+}
+
+double SCMTerrainOld::GetTraversabilityCellSize() const {
+    m_loader->UpdateTraversabilityMap();
+    return m_loader->m_traversability ? m_loader->m_traversability->cell_nodes * m_loader->m_delta : 0;
+}
+
+const std::vector<SCMTerrainOld::TraversabilityCell>& SCMTerrainOld::GetTraversabilityMap() const {
+    static const std::vector<TraversabilityCell> empty;
+    m_loader->UpdateTraversabilityMap();
+    return m_loader->m_traversability ? m_loader->m_traversability->cells : empty;
 }
 
 // Enable/disable co-simulation mode.
@@ -151,6 +597,7 @@ void SCMTerrainOld::SetSoilParameters(
     double elastic_K,      // elastic stiffness K per unit area, [Pa/m] (must be larger than Kphi)
     double damping_R       // vertical damping R per unit area [Pa.s/m] (proportional to vertical speed)
 ) {
+    m_loader->WaitBulldozing();
     m_loader->m_Bekker_Kphi = Bekker_Kphi;
     m_loader->m_Bekker_Kc = Bekker_Kc;
     m_loader->m_Bekker_n = Bekker_n;
@@ -163,6 +610,7 @@ void SCMTerrainOld::SetSoilParameters(
 
 // Enable/disable bulldozing effect.
 void SCMTerrainOld::EnableBulldozing(bool val) {
+    m_loader->WaitBulldozing();
     m_loader->m_bulldozing = val;
 }
 
@@ -173,10 +621,21 @@ void SCMTerrainOld::SetBulldozingParameters(
     int erosion_iterations,   // number of erosion refinements per timestep
     int erosion_propagations  // number of concentric vertex selections subject to erosion
 ) {
+    m_loader->WaitBulldozing();
     m_loader->m_flow_factor = flow_factor;
     m_loader->m_erosion_slope = std::tan(erosion_angle * CH_DEG_TO_RAD);
     m_loader->m_erosion_iterations = erosion_iterations;
     m_loader->m_erosion_propagations = erosion_propagations;
+    m_loader->ResetErosionDomain();
+}
+
+// Set the rate and execution mode of bulldozing effects.
+void SCMTerrainOld::SetBulldozingRate(int interval, bool async) {
+    m_loader->WaitBulldozing();
+    m_loader->FinishBulldozing();
+    m_loader->m_bulldozing_interval = std::max(interval, 1);
+    m_loader->m_bulldozing_counter = 0;
+    m_loader->m_bulldozing_async = async;
 }
 
 void SCMTerrainOld::SetTestHeight(double offset) {
@@ -192,6 +651,14 @@ void SCMTerrainOld::SetPlotType(DataPlotType plot_type, double min_val, double m
     m_loader->m_plot_type = plot_type;
     m_loader->m_plot_v_min = min_val;
     m_loader->m_plot_v_max = max_val;
+    m_loader->m_colormap_lut.clear();
+
+    // The scalar heightfield texture holds the previous plot quantity; recreate the textures at the next update
+    if (auto hf = m_loader->m_heightfield.get()) {
+        hf->width = 0;
+        hf->texels.clear();
+        hf->dirty.clear();
+    }
 }
 
 // Set the colormap type
@@ -200,6 +667,7 @@ void SCMTerrainOld::SetColormap(ChColormap::Type type) {
     if (m_loader->m_colormap) {
         m_loader->m_colormap->Load(type);
     }
+    m_loader->m_colormap_lut.clear();
 }
 
 // Get the current colormap
@@ -270,11 +738,158 @@ std::vector<SCMTerrainOld::NodeLevel> SCMTerrainOld::GetModifiedNodes(bool all_n
     return m_loader->GetModifiedNodes(all_nodes);
 }
 
+// Get the heights of modified grid nodes within an axis-aligned box of the SCM plane.
+std::vector<SCMTerrainOld::NodeLevel> SCMTerrainOld::GetModifiedNodes(const ChVector2d& min,
+                                                                      const ChVector2d& max,
+                                                                      bool all_nodes) const {
+    double delta = m_loader->m_delta;
+    ChVector2i ij_min((int)std::ceil(min.x() / delta), (int)std::ceil(min.y() / delta));
+    ChVector2i ij_max((int)std::floor(max.x() / delta), (int)std::floor(max.y() / delta));
+    return m_loader->GetModifiedNodes(ij_min, ij_max, [](const ChVector2i&) { return true; }, all_nodes);
+}
+
+// Get the heights of modified grid nodes within a polygon of the SCM plane.
+std::vector<SCMTerrainOld::NodeLevel> SCMTerrainOld::GetModifiedNodes(const std::vector<ChVector2d>& polygon,
+                                                                      bool all_nodes) const {
+    if (polygon.size() < 3)
+        return std::vector<NodeLevel>();
+
+    // Bounding box of the polygon
+    ChVector2d min = polygon[0];
+    ChVector2d max = polygon[0];
+    for (const auto& v : polygon) {
+        min.x() = std::min(min.x(), v.x());
+        min.y() = std::min(min.y(), v.y());
+        max.x() = std::max(max.x(), v.x());
+        max.y() = std::max(max.y(), v.y());
+    }
+
+    double delta = m_loader->m_delta;
+    ChVector2i ij_min((int)std::ceil(min.x() / delta), (int)std::ceil(min.y() / delta));
+    ChVector2i ij_max((int)std::floor(max.x() / delta), (int)std::floor(max.y() / delta));
+
+    // Point in polygon test (crossing number)
+    auto inside = [&polygon, delta](const ChVector2i& ij) {
+        double x = ij.x() * delta;
+        double y = ij.y() * delta;
+        bool in = false;
+        for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+            const auto& a = polygon[i];
+            const auto& b = polygon[j];
+            if ((a.y() > y) != (b.y() > y) && x < a.x() + (y - a.y()) * (b.x() - a.x()) / (b.y() - a.y()))
+                in = !in;
+        }
+        return in;
+    };
+
+    return m_loader->GetModifiedNodes(ij_min, ij_max, inside, all_nodes);
+}
+
 // Modify the level of grid nodes from the given list.
 void SCMTerrainOld::SetModifiedNodes(const std::vector<NodeLevel>& nodes) {
     m_loader->SetModifiedNodes(nodes);
 }
 
+// Encode the heights of modified grid nodes in the compact delta format.
+void SCMTerrainOld::EncodeModifiedNodes(std::vector<std::uint8_t>& buffer, double resolution, bool all_nodes) const {
+    m_loader->EncodeModifiedNodes(buffer, resolution, all_nodes);
+}
+
+// Decode the heights of grid nodes in the compact delta format.
+std::vector<SCMTerrainOld::NodeLevel> SCMTerrainOld::DecodeModifiedNodes(const std::uint8_t* data, size_t size) const {
+    std::vector<NodeLevel> nodes;
+    m_loader->DecodeModifiedNodes(data, size, [&nodes](const ChVector2i& ij, double level) {
+        nodes.push_back(std::make_pair(ij, level));
+    });
+    return nodes;
+}
+
+// Modify the level of grid nodes encoded in the compact delta format.
+// The buffer is decoded twice: a first pass (which throws on invalid data) ensures that nothing is applied from an
+// invalid buffer.
+void SCMTerrainOld::SetModifiedNodes(const std::uint8_t* data, size_t size) {
+    m_loader->DecodeModifiedNodes(data, size, [](const ChVector2i&, double) {});
+    m_loader->SetNodeLevels([&](auto set) { m_loader->DecodeModifiedNodes(data, size, set); });
+}
+
+// Apply a batch of grid node updates, preserving the deformation history of the nodes.
+void SCMTerrainOld::ApplyNodeUpdates(const std::vector<NodeUpdate>& updates, int fields) {
+    m_loader->ApplyNodeUpdates(updates, fields);
+}
+
+// Write a binary checkpoint of the complete SCM terrain state.
+void SCMTerrainOld::WriteCheckpoint(const std::string& filename) {
+    m_loader->WriteCheckpoint(filename);
+}
+
+// Write an incremental checkpoint, relative to the previous checkpoint of the current chain.
+void SCMTerrainOld::WriteCheckpointDelta(const std::string& filename) {
+    m_loader->WriteCheckpointDelta(filename);
+}
+
+// Restore the SCM terrain state from a binary checkpoint.
+void SCMTerrainOld::ReadCheckpoint(const std::string& filename) {
+    m_loader->ReadCheckpoint(std::vector<std::string>(1, filename));
+}
+
+// Restore the SCM terrain state from a checkpoint chain.
+void SCMTerrainOld::ReadCheckpoint(const std::vector<std::string>& filenames) {
+    m_loader->ReadCheckpoint(filenames);
+}
+
+// Merge a checkpoint chain into a single full checkpoint.
+void SCMTerrainOld::CompactCheckpoints(const std::vector<std::string>& filenames, const std::string& filename) {
+    SCMLoaderOld::CompactCheckpoints(filenames, filename);
+}
+
+// Start recording the terrain deformation to a log file.
+void SCMTerrainOld::StartRecording(const std::string& filename,
+                                   int keyframe_interval,
+                                   double resolution,
+                                   int buffer_frames) {
+    m_loader->StartRecording(filename, keyframe_interval, resolution, buffer_frames);
+}
+
+// Stop recording the terrain deformation.
+void SCMTerrainOld::StopRecording() {
+    m_loader->StopRecording();
+}
+
+// Split the SCM grid into subdomains simulated by separate processes.
+void SCMTerrainOld::SetDomainDecomposition(const std::string& name,
+                                           int num_x,
+                                           int num_y,
+                                           int rank,
+                                           int halo,
+                                           int max_shared_bodies) {
+    m_loader->SetDomainDecomposition(name, num_x, num_y, rank, halo, max_shared_bodies);
+}
+
+// Register a body which may interact with several subdomains.
+void SCMTerrainOld::AddSharedBody(std::shared_ptr<ChBody> body, int id) {
+    auto& dd = m_loader->m_decomposition;
+    if (!dd) {
+        std::cerr << "SCM domain decomposition not enabled" << std::endl;
+        throw std::runtime_error("SCM domain decomposition not enabled");
+    }
+    if (id < 0 || id >= dd->max_bodies) {
+        std::cerr << "Invalid identifier " << id << " for SCM shared body" << std::endl;
+        throw std::runtime_error("Invalid identifier for SCM shared body");
+    }
+    dd->bodies[body.get()] = id;
+}
+
+// Get the range of grid indices owned by this process.
+void SCMTerrainOld::GetSubdomainRange(ChVector2i& min, ChVector2i& max) const {
+    if (m_loader->m_decomposition) {
+        min = m_loader->m_decomposition->own_min;
+        max = m_loader->m_decomposition->own_max;
+    } else {
+        min = ChVector2i(-m_loader->m_nx, -m_loader->m_ny);
+        max = ChVector2i(m_loader->m_nx, m_loader->m_ny);
+    }
+}
+
 bool SCMTerrainOld::GetContactForceBody(std::shared_ptr<ChBody> body, ChVector3d& force, ChVector3d& torque) const {
     auto itr = m_loader->m_body_forces.find(body.get());
     if (itr == m_loader->m_body_forces.end()) {
@@ -319,6 +934,11 @@ int SCMTerrainOld::GetNumErosionNodes() const {
     return m_loader->m_num_erosion_nodes;
 }
 
+// Return the running aggregate statistics of the terrain deformation.
+const SCMTerrainOld::DeformationStats& SCMTerrainOld::GetDeformationStats() const {
+    return m_loader->m_stats;
+}
+
 // Timer information
 double SCMTerrainOld::GetTimerActiveDomains() const {
     return 1e3 * m_loader->m_timer_active_domains();
@@ -341,6 +961,9 @@ double SCMTerrainOld::GetTimerBulldozing() const {
 double SCMTerrainOld::GetTimerVisUpdate() const {
     return 1e3 * m_loader->m_timer_visualization();
 }
+double SCMTerrainOld::GetTimerSubdomainExchange() const {
+    return 1e3 * m_loader->m_timer_subdomain_exchange();
+}
 
 void SCMTerrainOld::SetBaseMeshLevel(double level) {
     m_loader->m_base_height = level;
@@ -359,6 +982,8 @@ void SCMTerrainOld::PrintStepStatistics(std::ostream& os) const {
     os << "      Compute domain:       " << 1e3 * m_loader->m_timer_bulldozing_domain() << std::endl;
     os << "      Apply erosion:        " << 1e3 * m_loader->m_timer_bulldozing_erosion() << std::endl;
     os << "   Visualization:           " << 1e3 * m_loader->m_timer_visualization() << std::endl;
+    if (m_loader->m_decomposition)
+        os << "   Subdomain exchange:      " << 1e3 * m_loader->m_timer_subdomain_exchange() << std::endl;
 
     os << " Counters:" << std::endl;
     os << "   Number ray casts:        " << m_loader->m_num_ray_casts << std::endl;
@@ -385,7 +1010,7 @@ SCMContactableData::SCMContactableData(double area_ratio,
 // -----------------------------------------------------------------------------
 
 // Constructor.
-SCMLoaderOld::SCMLoaderOld(ChSystem* system, bool visualization_mesh) : m_soil_fun(nullptr), m_base_height(-1000) {
+SCMLoaderOld::SCMLoaderOld(ChSystem* system, bool visualization_mesh) : m_base_height(-1000), m_soil_fun(nullptr) {
     this->SetSystem(system);
 
     if (visualization_mesh) {
@@ -405,6 +1030,26 @@ SCMLoaderOld::SCMLoaderOld(ChSystem* system, bool visualization_mesh) : m_soil_f
     m_erosion_slope = std::tan(40.0 * CH_DEG_TO_RAD);
     m_erosion_iterations = 3;
     m_erosion_propagations = 10;
+    m_bulldozing_interval = 1;
+    m_bulldozing_counter = 0;
+    m_bulldozing_async = false;
+
+    // State snapshots
+    m_state_snapshots = false;
+
+    // Incremental checkpoints (no checkpoint chain)
+    m_ckpt_chain = 0;
+    m_ckpt_sequence = 0;
+    m_ckpt_ntx = 0;
+    m_ckpt_nty = 0;
+
+    // Visualization mesh tiling
+    m_tile_size = 0;
+    m_tile_lods = 1;
+    m_tile_lod_distance = 1;
+    m_tile_lod_reference = VNULL;
+    m_ntx = 0;
+    m_nty = 0;
 
     // Default soil parameters
     m_Bekker_Kphi = 2e6;
@@ -421,6 +1066,9 @@ SCMLoaderOld::SCMLoaderOld(ChSystem* system, bool visualization_mesh) : m_soil_f
     m_plot_v_min = 0;
     m_plot_v_max = 0.2;
 
+    m_vis_update_interval = 1.0 / 60;
+    m_vis_update_time = -std::numeric_limits<double>::infinity();
+
     m_test_offset_up = 0.1;
     m_test_offset_down = 0.5;
 
@@ -444,7 +1092,6 @@ void SCMLoaderOld::Initialize(double sizeX, double sizeY, double delta) {
         return;
 
     CreateVisualizationMesh(sizeX, sizeY);
-    this->AddVisualShape(m_trimesh_shape);
 }
 
 // Initialize the terrain from a specified height map.
@@ -523,7 +1170,6 @@ void SCMLoaderOld::Initialize(const std::string& heightmap_file,
         return;
 
     CreateVisualizationMesh(sizeX, sizeY);
-    this->AddVisualShape(m_trimesh_shape);
 }
 
 // Initialize the terrain from a specified OBJ mesh file.
@@ -622,12 +1268,20 @@ void SCMLoaderOld::Initialize(const ChTriangleMeshConnected& trimesh, double del
         return;
 
     CreateVisualizationMesh(sizeX, sizeY);
-    this->AddVisualShape(m_trimesh_shape);
 }
 
 void SCMLoaderOld::CreateVisualizationMesh(double sizeX, double sizeY) {
     // Create the colormap
     m_colormap = chrono_types::make_unique<ChColormap>(m_colormap_type);
+    m_colormap_lut.clear();
+
+    // Tiled level-of-detail visualization mesh
+    if (m_tile_size > 0) {
+        CreateMeshTiles();
+        return;
+    }
+
+    this->AddVisualShape(m_trimesh_shape);
 
     int nvx = 2 * m_nx + 1;                     // number of grid vertices in X direction
     int nvy = 2 * m_ny + 1;                     // number of grid vertices in Y direction
@@ -646,6 +1300,11 @@ void SCMLoaderOld::CreateVisualizationMesh(double sizeX, double sizeY) {
     std::vector<ChVector2d>& uv_coords = trimesh->GetCoordsUV();
     std::vector<ChColor>& colors = trimesh->GetCoordsColors();
 
+    // Reset the list of modified vertices
+    m_vis_vertices.clear();
+    m_vis_dirty.assign(n_verts, false);
+    m_vis_face_normals.resize(2 * 2 * (nvx + 1));
+
     // Resize mesh arrays.
     vertices.resize(n_verts);
     normals.resize(n_verts);
@@ -726,6 +1385,115 @@ void SCMLoaderOld::CreateVisualizationMesh(double sizeX, double sizeY) {
     }
 }
 
+// Create the tiles of the visualization mesh (tiled level-of-detail mode).
+// All tiles are initially built at the coarsest level of detail.
+void SCMLoaderOld::CreateMeshTiles() {
+    int nx = 2 * m_nx;  // number of grid cells in X direction
+    int ny = 2 * m_ny;  // number of grid cells in Y direction
+    m_ntx = (nx + m_tile_size - 1) / m_tile_size;
+    m_nty = (ny + m_tile_size - 1) / m_tile_size;
+
+    m_vis_vertices.clear();
+    m_vis_dirty.clear();
+    m_vis_face_normals.resize(2 * 2 * (m_tile_size + 2));
+
+    m_mesh_tiles.clear();
+    m_mesh_tiles.resize(m_ntx * m_nty);
+    for (int ty = 0; ty < m_nty; ty++) {
+        for (int tx = 0; tx < m_ntx; tx++) {
+            auto& tile = m_mesh_tiles[tx + m_ntx * ty];
+            tile.shape = chrono_types::make_shared<ChVisualShapeTriangleMesh>();
+            tile.shape->SetWireframe(m_trimesh_shape->IsWireframe());
+            tile.origin = ChVector2i(-m_nx + tx * m_tile_size, -m_ny + ty * m_tile_size);
+            tile.cells = ChVector2i(std::min(m_tile_size, nx - tx * m_tile_size),  //
+                                    std::min(m_tile_size, ny - ty * m_tile_size));
+            BuildMeshTile(tile, m_tile_lods - 1);
+            this->AddVisualShape(tile.shape);
+        }
+    }
+}
+
+// Build the specified visualization mesh tile at the given level of detail.
+// The tile mesh uses every 2^lod-th grid node, as well as the nodes on the last row and column of the tile.
+// Nodes not yet in the grid map are placed at their initial height.
+void SCMLoaderOld::BuildMeshTile(MeshTile& tile, int lod) {
+    int stride = 1 << lod;
+    int nvx = (tile.cells.x() + stride - 1) / stride + 1;  // number of tile vertices in X direction
+    int nvy = (tile.cells.y() + stride - 1) / stride + 1;  // number of tile vertices in Y direction
+    int n_verts = nvx * nvy;                               // total number of tile vertices
+    int n_faces = 2 * (nvx - 1) * (nvy - 1);               // total number of tile faces
+    double x_scale = 0.5 / m_nx;                           // scale for texture coordinates (U direction)
+    double y_scale = 0.5 / m_ny;                           // scale for texture coordinates (V direction)
+
+    // Readability aliases
+    auto& trimesh = *tile.shape->GetMesh();
+    std::vector<ChVector3d>& vertices = trimesh.GetCoordsVertices();
+    std::vector<ChVector3d>& normals = trimesh.GetCoordsNormals();
+    std::vector<ChVector3i>& idx_vertices = trimesh.GetIndicesVertexes();
+    std::vector<ChVector3i>& idx_normals = trimesh.GetIndicesNormals();
+    std::vector<ChVector2d>& uv_coords = trimesh.GetCoordsUV();
+    std::vector<ChColor>& colors = trimesh.GetCoordsColors();
+
+    // Resize mesh arrays
+    vertices.resize(n_verts);
+    normals.resize(n_verts);
+    uv_coords.resize(n_verts);
+    colors.resize(n_verts);
+    idx_vertices.resize(n_faces);
+    idx_normals.resize(n_faces);
+
+    // Load mesh vertices (UV coordinates consistent with the full-resolution mesh)
+    std::vector<int> node_vertices;  // vertices at nodes in the grid map
+    m_vis_records.clear();
+    int iv = 0;
+    for (int kv = 0; kv < nvy; kv++) {
+        int v = std::min(kv * stride, tile.cells.y());
+        for (int ku = 0; ku < nvx; ku++) {
+            int u = std::min(ku * stride, tile.cells.x());
+            ChVector2i ij(tile.origin.x() + u, tile.origin.y() + v);
+            uv_coords[iv] = ChVector2d((ij.x() + m_nx) * x_scale, (ij.y() + m_ny) * y_scale);
+            colors[iv] = ChColor(1, 1, 1);
+            auto rec = m_grid_map.find(ij);
+            if (rec != m_grid_map.end()) {
+                UpdateMeshVertexCoordinates(trimesh, ij, iv, rec->second);
+                node_vertices.push_back(iv);
+                m_vis_records.push_back(&rec->second);
+            } else {
+                vertices[iv] =
+                    m_frame.TransformPointLocalToParent(ChVector3d(ij.x() * m_delta, ij.y() * m_delta, GetInitHeight(ij)));
+            }
+            ++iv;
+        }
+    }
+
+    if (m_plot_type != SCMTerrainOld::PLOT_NONE)
+        UpdateMeshVertexColors(trimesh, node_vertices, m_vis_records);
+
+    // Specify triangular faces (same layout as the full-resolution mesh)
+    int it = 0;
+    for (int kv = 0; kv < nvy - 1; kv++) {
+        for (int ku = 0; ku < nvx - 1; ku++) {
+            int v0 = ku + nvx * kv;
+            idx_vertices[it] = ChVector3i(v0, v0 + 1, v0 + nvx + 1);
+            idx_normals[it] = ChVector3i(v0, v0 + 1, v0 + nvx + 1);
+            ++it;
+            idx_vertices[it] = ChVector3i(v0, v0 + nvx + 1, v0 + nvx);
+            idx_normals[it] = ChVector3i(v0, v0 + nvx + 1, v0 + nvx);
+            ++it;
+        }
+    }
+
+    // Calculate vertex normals
+    UpdateMeshVertexNormals(trimesh, nvx, nvy, 0, 0, nvx, nvy);
+
+    tile.lod = lod;
+    tile.vertices.clear();
+    tile.dirty.assign(n_verts, false);
+
+    // The mesh connectivity changed, so all vertices must be refreshed by the renderer
+    tile.shape->SetModifiedVertices(std::vector<int>());
+}
+
 void SCMLoaderOld::SetupInitial() {
     // If no user-specified active domains, create one that will encompass all collision shapes in the system
     if (!m_user_domains) {
@@ -776,37 +1544,51 @@ SCMTerrainOld::NodeInfo SCMLoaderOld::GetNodeInfo(const ChVector3d& loc) const {
     return ni;
 }
 
-// Get index of trimesh vertex corresponding to the specified grid vertex.
-int SCMLoaderOld::GetMeshVertexIndex(const ChVector2i& loc) {
-    assert(loc.x() >= -m_nx);
-    assert(loc.x() <= +m_nx);
-    assert(loc.y() >= -m_ny);
-    assert(loc.y() <= +m_ny);
-    return (loc.x() + m_nx) + (2 * m_nx + 1) * (loc.y() + m_ny);
-}
-
-// Get indices of trimesh faces incident to the specified grid vertex.
-std::vector<int> SCMLoaderOld::GetMeshFaceIndices(const ChVector2i& loc) {
-    int i = loc.x();
-    int j = loc.y();
+// Export SCM information at all grid nodes in a rectangular window.
+// Output buffers are first set to the values of undeformed nodes, then the records of all grid map nodes in the
+// window (located through the spatial index) are scattered in a single pass.
+void SCMLoaderOld::ExportNodeInfo(const ChVector2i& start,
+                                  int width,
+                                  int height,
+                                  const SCMTerrainOld::NodeInfoBuffers& buffers) const {
+    if (width <= 0 || height <= 0)
+        return;
 
-    // Ignore boundary vertices
-    if (i == -m_nx || i == m_nx || j == -m_ny || j == m_ny)
-        return std::vector<int>();
+    double* fields[7] = {buffers.sinkage, buffers.sinkage_plastic, buffers.sinkage_elastic, buffers.sigma,
+                         buffers.sigma_yield, buffers.kshear, buffers.tau};
+    size_t size = (size_t)width * (size_t)height;
+    for (auto f : fields) {
+        if (f)
+            std::fill(f, f + size, 0.0);
+    }
 
-    // Load indices of 6 adjacent faces
-    i += m_nx;
-    j += m_ny;
-    int nx = 2 * m_nx;
-    std::vector<int> faces(6);
-    faces[0] = 2 * ((i - 1) + nx * (j - 1));
-    faces[1] = 2 * ((i - 1) + nx * (j - 1)) + 1;
-    faces[2] = 2 * ((i - 1) + nx * (j - 0));
-    faces[3] = 2 * ((i - 0) + nx * (j - 0));
-    faces[4] = 2 * ((i - 0) + nx * (j - 0)) + 1;
-    faces[5] = 2 * ((i - 0) + nx * (j - 1)) + 1;
+    ChVector2i end(start.x() + width - 1, start.y() + height - 1);
+    VisitIndexedNodes(start, end, [&](const ChVector2i& ij, const NodeRecord& nr) {
+        size_t k = (size_t)(ij.x() - start.x()) + (size_t)width * (size_t)(ij.y() - start.y());
+        if (buffers.sinkage)
+            buffers.sinkage[k] = nr.sinkage;
+        if (buffers.sinkage_plastic)
+            buffers.sinkage_plastic[k] = nr.sinkage_plastic;
+        if (buffers.sinkage_elastic)
+            buffers.sinkage_elastic[k] = nr.sinkage_elastic;
+        if (buffers.sigma)
+            buffers.sigma[k] = nr.sigma;
+        if (buffers.sigma_yield)
+            buffers.sigma_yield[k] = nr.sigma_yield;
+        if (buffers.kshear)
+            buffers.kshear[k] = nr.kshear;
+        if (buffers.tau)
+            buffers.tau[k] = nr.tau;
+    });
+}
 
-    return faces;
+// Get index of trimesh vertex corresponding to the specified grid vertex.
+int SCMLoaderOld::GetMeshVertexIndex(const ChVector2i& loc) {
+    assert(loc.x() >= -m_nx);
+    assert(loc.x() <= +m_nx);
+    assert(loc.y() >= -m_ny);
+    assert(loc.y() <= +m_ny);
+    return (loc.x() + m_nx) + (2 * m_nx + 1) * (loc.y() + m_ny);
 }
 
 // Get the initial undeformed terrain height (relative to the SCM plane) at the specified grid vertex.
@@ -932,6 +1714,93 @@ ChVector3d SCMLoaderOld::GetNormal(const ChVector3d& loc) const {
     return ChWorldFrame::FromISO(nrm_abs);
 }
 
+// Get the terrain heights (and optionally normals) below the specified locations.
+// The query is processed in passes over all locations: (1) transform to the SCM frame and locate the grid cells,
+// (2) gather the heights at the 4 cell corners (grid map or initial height), (3) interpolate heights and height
+// gradients (vectorized, no lookups), and (4) transform back to the World frame.
+void SCMLoaderOld::GetHeights(const ChVector3d* locs, size_t n, double* heights, ChVector3d* normals) const {
+    m_query_values.resize(8 * n);
+    double* x = m_query_values.data();  // local X coordinates
+    double* y = x + n;       // local Y coordinates
+    double* fx = y + n;      // fractional position in grid cell (X direction)
+    double* fy = fx + n;     // fractional position in grid cell (Y direction)
+    double* h00 = fy + n;    // heights at cell corners
+    double* h10 = h00 + n;
+    double* h01 = h10 + n;
+    double* h11 = h01 + n;
+
+    // Express locations in the SCM frame and find enclosing grid cells
+    auto& cells = m_query_cells;
+    cells.resize(n);
+    for (size_t k = 0; k < n; k++) {
+        ChVector3d loc_loc = m_frame.TransformPointParentToLocal(locs[k]);
+        x[k] = loc_loc.x();
+        y[k] = loc_loc.y();
+        double i = std::floor(x[k] / m_delta);
+        double j = std::floor(y[k] / m_delta);
+        fx[k] = x[k] / m_delta - i;
+        fy[k] = y[k] / m_delta - j;
+        cells[k] = ChVector2i(static_cast<int>(i), static_cast<int>(j));
+    }
+
+    // Gather heights at cell corners.
+    // Nearby locations share grid nodes, so node heights are cached in a small direct-mapped table indexed by the
+    // node location modulo 32 in each direction (no collisions within any 32 x 32 block of nodes).
+    // The table is emptied at each query, as node heights may have changed since the previous one.
+    auto& cache_nodes = m_query_cache_nodes;
+    auto& cache_heights = m_query_cache_heights;
+    cache_nodes.assign(32 * 32, ChVector2i(std::numeric_limits<int>::min()));
+    cache_heights.resize(32 * 32);
+    auto node_height = [&](const ChVector2i& ij) {
+        int slot = (ij.x() & 31) | ((ij.y() & 31) << 5);
+        if (!(cache_nodes[slot] == ij)) {
+            cache_nodes[slot] = ij;
+            cache_heights[slot] = GetHeight(ij);
+        }
+        return cache_heights[slot];
+    };
+    for (size_t k = 0; k < n; k++) {
+        const auto& ij = cells[k];
+        h00[k] = node_height(ij);
+        h10[k] = node_height(ij + ChVector2i(1, 0));
+        h01[k] = node_height(ij + ChVector2i(0, 1));
+        h11[k] = node_height(ij + ChVector2i(1, 1));
+    }
+
+    // Bilinear interpolation of heights (results stored in place of corner heights)
+    // and of height gradients (local normal directions, stored in place of fractional positions)
+    double* h = h00;
+    double* nx = fx;
+    double* ny = fy;
+    double idelta = 1 / m_delta;
+#pragma omp simd
+    for (size_t k = 0; k < n; k++) {
+        double dx0 = h10[k] - h00[k];
+        double dx1 = h11[k] - h01[k];
+        double dy0 = h01[k] - h00[k];
+        double dy1 = h11[k] - h10[k];
+        double hk = h00[k] + fx[k] * dx0 + fy[k] * (dy0 + fx[k] * (dx1 - dx0));
+        double gx = (dx0 + fy[k] * (dx1 - dx0)) * idelta;
+        double gy = (dy0 + fx[k] * (dy1 - dy0)) * idelta;
+        h[k] = hk;
+        nx[k] = -gx;
+        ny[k] = -gy;
+    }
+
+    // Express in global frame
+    for (size_t k = 0; k < n; k++) {
+        ChVector3d loc_abs = m_frame.TransformPointLocalToParent(ChVector3d(x[k], y[k], h[k]));
+        heights[k] = ChWorldFrame::Height(loc_abs);
+    }
+    if (normals) {
+        for (size_t k = 0; k < n; k++) {
+            auto nrm_loc = ChVector3d(nx[k], ny[k], 1).GetNormalized();
+            auto nrm_abs = m_frame.TransformDirectionLocalToParent(nrm_loc);
+            normals[k] = ChWorldFrame::FromISO(nrm_abs);
+        }
+    }
+}
+
 // Synchronize information for a user-provided active domain
 void SCMLoaderOld::UpdateActiveDomain(ActiveDomainInfo& ad, const ChVector3d& Z) {
     ChVector2d p_min(+std::numeric_limits<double>::max());
@@ -962,8 +1831,17 @@ void SCMLoaderOld::UpdateActiveDomain(ActiveDomainInfo& ad, const ChVector3d& Z)
     int y_min = static_cast<int>(std::ceil(p_min.y() / m_delta));
     int x_max = static_cast<int>(std::floor(p_max.x() / m_delta));
     int y_max = static_cast<int>(std::floor(p_max.y() / m_delta));
-    int n_x = x_max - x_min + 1;
-    int n_y = y_max - y_min + 1;
+
+    // With domain decomposition, restrict to the local subdomain (owned nodes and ghost layer)
+    if (m_decomposition) {
+        x_min = std::max(x_min, m_decomposition->local_min.x());
+        y_min = std::max(y_min, m_decomposition->local_min.y());
+        x_max = std::min(x_max, m_decomposition->local_max.x());
+        y_max = std::min(y_max, m_decomposition->local_max.y());
+    }
+
+    int n_x = std::max(x_max - x_min + 1, 0);
+    int n_y = std::max(y_max - y_min + 1, 0);
 
     ad.m_range.resize(n_x * n_y);
     for (int i = 0; i < n_x; i++) {
@@ -1013,8 +1891,17 @@ void SCMLoaderOld::UpdateDefaultActiveDomain(ActiveDomainInfo& ad) {
     int y_min = static_cast<int>(std::ceil(p_min.y() / m_delta));
     int x_max = static_cast<int>(std::floor(p_max.x() / m_delta));
     int y_max = static_cast<int>(std::floor(p_max.y() / m_delta));
-    int n_x = x_max - x_min + 1;
-    int n_y = y_max - y_min + 1;
+
+    // With domain decomposition, restrict to the local subdomain (owned nodes and ghost layer)
+    if (m_decomposition) {
+        x_min = std::max(x_min, m_decomposition->local_min.x());
+        y_min = std::max(y_min, m_decomposition->local_min.y());
+        x_max = std::min(x_max, m_decomposition->local_max.x());
+        y_max = std::min(y_max, m_decomposition->local_max.y());
+    }
+
+    int n_x = std::max(x_max - x_min + 1, 0);
+    int n_y = std::max(y_max - y_min + 1, 0);
 
     ad.m_range.resize(n_x * n_y);
     for (int i = 0; i < n_x; i++) {
@@ -1025,7 +1912,7 @@ void SCMLoaderOld::UpdateDefaultActiveDomain(ActiveDomainInfo& ad) {
 }
 
 // Ray-OBB intersection test
-bool SCMLoaderOld::RayOBBtest(const ActiveDomainInfo& p, const ChVector3d& from, const ChVector3d& Z) {
+bool SCMLoaderOld::RayOBBtest(const ActiveDomainInfo& p, const ChVector3d& from) {
     // Express ray origin in OBB frame
     ChVector3d orig = p.m_body->GetFrameRefToAbs().TransformPointParentToLocal(from) - p.m_center;
 
@@ -1072,30 +1959,51 @@ static const std::vector<ChVector2i> neighbors4{
 
 // Reset the list of forces, and fills it with forces from a soil contact model.
 void SCMLoaderOld::ComputeInternalForces() {
-    // Initialize list of modified visualization mesh vertices (use any externally modified vertices)
-    std::vector<int> modified_vertices = m_external_modified_vertices;
-    m_external_modified_vertices.clear();
+    // Complete any deferred bulldozing job from the previous step (before any modification of the grid map)
+    WaitBulldozing();
 
     // Reset quantities at grid nodes modified over previous step
     // (required for bulldozing effects and for proper visualization coloring)
-    for (const auto& ij : m_modified_nodes) {
+    auto reset = [this](const ChVector2i& ij) {
         auto& nr = m_grid_map.at(ij);
+        MarkCheckpointNode(ij);
+        // Ghost nodes keep the state received from their owner (which publishes them again once reset)
+        if (m_decomposition && GetSubdomain(ij) != m_decomposition->rank)
+            return;
         nr.sigma = 0;
         nr.sinkage_elastic = 0;
         nr.step_plastic_flow = 0;
-        nr.erosion = false;
         nr.hit_level = 1e9;
+    };
+    for (const auto& ij : m_modified_nodes)
+        reset(ij);
+
+    // Nodes modified by a deferred bulldozing job are only listed with this step (see FinishBulldozing), but are reset
+    // now, as with synchronous bulldozing
+    if (m_bulldozing_job.pending) {
+        for (const auto& ij : m_bulldozing_job.modified)
+            reset(ij);
+    }
 
-        // Update visualization (only color changes relevant here)
-        if (m_trimesh_shape && CheckMeshBounds(ij)) {
-            int iv = GetMeshVertexIndex(ij);          // mesh vertex index
-            UpdateMeshVertexCoordinates(ij, iv, nr);  // update vertex coordinates and color
-            modified_vertices.push_back(iv);
-        }
+    // Reset nodes change in the state snapshots
+    if (m_state_snapshots)
+        MarkSnapshotNodes(m_modified_nodes);
+
+    // Reset nodes change color in the visualization mesh
+    if (m_trimesh_shape || m_heightfield || m_traversability) {
+        for (const auto& ij : m_modified_nodes)
+            MarkVisualizationNode(ij);
     }
 
     m_modified_nodes.clear();
 
+    // Nodes modified by data received from other subdomains after the last step (see ExchangeSubdomains)
+    if (m_decomposition) {
+        auto& applied = m_decomposition->applied;
+        m_modified_nodes.insert(m_modified_nodes.end(), applied.begin(), applied.end());
+        applied.clear();
+    }
+
     // Reset timers
     m_timer_active_domains.reset();
     m_timer_ray_testing.reset();
@@ -1106,8 +2014,16 @@ void SCMLoaderOld::ComputeInternalForces() {
     m_timer_bulldozing_boundary.reset();
     m_timer_bulldozing_domain.reset();
     m_timer_bulldozing_erosion.reset();
+    m_timer_subdomain_exchange.reset();
     m_timer_visualization.reset();
 
+    m_num_erosion_nodes = 0;
+
+    // Collect results of deferred bulldozing (applied at the start of this step)
+    m_timer_bulldozing.start();
+    FinishBulldozing();
+    m_timer_bulldozing.stop();
+
     // Reset the load list and map of contact forces
     this->GetLoadList().clear();
     m_body_forces.clear();
@@ -1158,7 +2074,7 @@ void SCMLoaderOld::ComputeInternalForces() {
         // Loop through all vertices in the patch range
         int num_ray_casts = 0;
     #pragma omp parallel for num_threads(nthreads) reduction(+ : num_ray_casts)
-        for (int k = 0; k < p.m_range.size(); k++) {
+        for (int k = 0; k < (int)p.m_range.size(); k++) {
             ChVector2i ij = p.m_range[k];
 
             // Move from (i, j) to (x, y, z) representation in the world frame
@@ -1176,7 +2092,7 @@ void SCMLoaderOld::ComputeInternalForces() {
             ChVector3d from = to - m_Z * m_test_offset_down;
 
             // Ray-OBB test (quick rejection)
-            if (m_user_domains && !RayOBBtest(p, from, m_Z))
+            if (m_user_domains && !RayOBBtest(p, from))
                 continue;
 
             // Cast ray into collision system
@@ -1189,6 +2105,7 @@ void SCMLoaderOld::ComputeInternalForces() {
                     // If this is the first hit from this node, initialize the node record
                     if (m_grid_map.find(ij) == m_grid_map.end()) {
                         m_grid_map.insert(std::make_pair(ij, NodeRecord(z, z, GetInitNormal(ij))));
+                        IndexNode(ij);
                     }
 
                     // Add to our map of hits to process
@@ -1216,7 +2133,7 @@ void SCMLoaderOld::ComputeInternalForces() {
         // Loop through all vertices in the patch range
         int num_ray_casts = 0;
     #pragma omp parallel for num_threads(nthreads) reduction(+ : num_ray_casts)
-        for (int k = 0; k < p.m_range.size(); k++) {
+        for (int k = 0; k < (int)p.m_range.size(); k++) {
             int t_num = ChOMP::GetThreadNum();
             ChVector2i ij = p.m_range[k];
 
@@ -1239,7 +2156,7 @@ void SCMLoaderOld::ComputeInternalForces() {
             ChVector3d from = to - m_Z * m_test_offset_down;
 
             // Ray-OBB test (quick rejection)
-            if (m_user_domains && !RayOBBtest(p, from, m_Z))
+            if (m_user_domains && !RayOBBtest(p, from))
                 continue;
 
             // Cast ray into collision system
@@ -1264,6 +2181,7 @@ void SCMLoaderOld::ComputeInternalForces() {
                 if (m_grid_map.find(h.first) == m_grid_map.end()) {
                     double z = GetInitHeight(h.first);
                     m_grid_map.insert(std::make_pair(h.first, NodeRecord(z, z, GetInitNormal(h.first))));
+                    IndexNode(h.first);
                 }
                 ////hits.insert(h);
             }
@@ -1374,10 +2292,16 @@ void SCMLoaderOld::ComputeInternalForces() {
     double damping_R = m_damping_R;
 
     // Process only hit nodes
+    int num_touched = 0;  // nodes in contact this step (m_modified_nodes may also hold nodes of a bulldozing job)
     for (auto& h : hits) {
+        // Ghost nodes only contribute to contact patches; they are updated by their owner
+        if (m_decomposition && GetSubdomain(h.first) != m_decomposition->rank)
+            continue;
+
         ChVector2d ij = h.first;
 
         auto& nr = m_grid_map.at(ij);      // node record
+        MarkCheckpointNode(h.first);
         const double& ca = nr.normal.z();  // cosine of angle between local normal and SCM plane vertical
 
         ChContactable* contactable = h.second.contactable;
@@ -1407,6 +2331,10 @@ void SCMLoaderOld::ComputeInternalForces() {
 
         // Mark current node as modified
         m_modified_nodes.push_back(ij);
+        num_touched++;
+
+        double level_prev = nr.level;              // level before this step (aggregate statistics)
+        double plastic_prev = nr.sinkage_plastic;  // plastic sinkage before this step (aggregate statistics)
 
         // Calculate velocity at touched grid node
         ChVector3d point_local(ij.x() * m_delta, ij.y() * m_delta, nr.level);
@@ -1522,11 +2450,21 @@ void SCMLoaderOld::ComputeInternalForces() {
         // Update grid node height (in local SCM frame, along SCM z axis)
         nr.level = nr.level_initial - nr.sinkage / ca;
 
+        // Update aggregate statistics
+        m_stats.plastic_volume += (nr.sinkage_plastic - plastic_prev) * m_area;
+        m_stats.net_volume += (nr.level - level_prev) * m_area;
+        m_stats.max_sinkage = std::max(m_stats.max_sinkage, nr.sinkage);
+
     }  // end loop on ray hits
 
-    // Create loads for bodies and nodes to apply the accumulated terrain force/torque for each of them
+    m_stats.num_touched_nodes = num_touched;
+
+    // Create loads for bodies and nodes to apply the accumulated terrain force/torque for each of them.
+    // With domain decomposition, loads on shared bodies are created by their owner after the force reduction.
     if (!m_cosim_mode) {
         for (const auto& f : m_body_forces) {
+            if (m_decomposition && m_decomposition->bodies.count(f.first))
+                continue;
             std::shared_ptr<ChBody> sbody(f.first, [](ChBody*) {});
             auto force_load =
                 chrono_types::make_shared<ChLoadBodyForce>(sbody, f.second.first, false, sbody->GetPos(), false);
@@ -1549,181 +2487,66 @@ void SCMLoaderOld::ComputeInternalForces() {
 
     m_timer_bulldozing.start();
 
-    m_num_erosion_nodes = 0;
-
     if (m_bulldozing) {
-        typedef std::unordered_set<ChVector2i, CoordHash> NodeSet;
-
-        // Maximum level change between neighboring nodes (smoothing phase)
-        double dy_lim = m_delta * m_erosion_slope;
-
-        // (1) Raise boundaries of each contact patch
-        m_timer_bulldozing_boundary.start();
-
-        NodeSet boundary;  // union of contact patch boundaries
-        for (auto p : contact_patches) {
-            NodeSet p_boundary;  // boundary of effective contact patch
-
-            // Calculate the displaced material from all touched nodes and identify boundary
-            double tot_step_flow = 0;
-            for (const auto& ij : p.nodes) {                 // for each node in contact patch
-                const auto& nr = m_grid_map.at(ij);          //   get node record
-                if (nr.sigma <= 0)                           //   if node not touched
-                    continue;                                //     skip (not in effective patch)
-                tot_step_flow += nr.step_plastic_flow;       //   accumulate displaced material
-                for (int k = 0; k < 4; k++) {                //   check each node neighbor
-                    ChVector2i nbr_ij = ij + neighbors4[k];  //     neighbor node coordinates
-                    ////if (!CheckMeshBounds(nbr_ij))                     //     if neighbor out of bounds
-                    ////    continue;                                     //       skip neighbor
-                    if (m_grid_map.find(nbr_ij) == m_grid_map.end())  //     if neighbor not yet recorded
-                        p_boundary.insert(nbr_ij);                    //       set neighbor as boundary
-                    else if (m_grid_map.at(nbr_ij).sigma <= 0)        //     if neighbor not touched
-                        p_boundary.insert(nbr_ij);                    //       set neighbor as boundary
-                }
-            }
-            tot_step_flow *= GetSystem()->GetStep();
-
-            // Target raise amount for each boundary node (unless clamped)
-            double diff = m_flow_factor * tot_step_flow / p_boundary.size();
-
-            // Raise boundary (create a sharp spike which will be later smoothed out with erosion)
-            for (const auto& ij : p_boundary) {                                  // for each node in bndry
-                m_modified_nodes.push_back(ij);                                  //   mark as modified
-                if (m_grid_map.find(ij) == m_grid_map.end()) {                   //   if not yet recorded
-                    double z = GetInitHeight(ij);                                //     undeformed height
-                    const ChVector3d& n = GetInitNormal(ij);                     //     terrain normal
-                    m_grid_map.insert(std::make_pair(ij, NodeRecord(z, z, n)));  //     add new node record
-                    m_modified_nodes.push_back(ij);                              //     mark as modified
-                }                                                                //
-                auto& nr = m_grid_map.at(ij);                                    //   node record
-                nr.erosion = true;                                               //   add to erosion domain
-                AddMaterialToNode(diff, nr);                                     //   add raise amount
-            }
-
-            // Accumulate boundary
-            boundary.insert(p_boundary.begin(), p_boundary.end());
-
-        }  // end for contact_patches
-
-        m_timer_bulldozing_boundary.stop();
-
-        // (2) Calculate erosion domain (dilate boundary)
-        m_timer_bulldozing_domain.start();
-
-        NodeSet erosion_domain = boundary;
-        NodeSet erosion_front = boundary;  // initialize erosion front to boundary nodes
-        for (int i = 0; i < m_erosion_propagations; i++) {
-            NodeSet front;                                   // new erosion front
-            for (const auto& ij : erosion_front) {           // for each node in current erosion front
-                for (int k = 0; k < 4; k++) {                // check each of its neighbors
-                    ChVector2i nbr_ij = ij + neighbors4[k];  //   neighbor node coordinates
-                    ////if (!CheckMeshBounds(nbr_ij))                       //   if out of bounds
-                    ////    continue;                                       //     ignore neighbor
-                    if (m_grid_map.find(nbr_ij) == m_grid_map.end()) {  //   if neighbor not yet recorded
-                        double z = GetInitHeight(nbr_ij);               //     undeformed height at neighbor location
-                        const ChVector3d& n = GetInitNormal(nbr_ij);    //     terrain normal at neighbor location
-                        NodeRecord nr(z, z, n);                         //     create new record
-                        nr.erosion = true;                              //     include in erosion domain
-                        m_grid_map.insert(std::make_pair(nbr_ij, nr));  //     add new node record
-                        front.insert(nbr_ij);                           //     add neighbor to new front
-                        m_modified_nodes.push_back(nbr_ij);             //     mark as modified
-                    } else {                                            //   if neighbor previously recorded
-                        NodeRecord& nr = m_grid_map.at(nbr_ij);         //     get existing record
-                        if (!nr.erosion && nr.sigma <= 0) {             //     if neighbor not touched
-                            nr.erosion = true;                          //       include in erosion domain
-                            front.insert(nbr_ij);                       //       add neighbor to new front
-                            m_modified_nodes.push_back(nbr_ij);         //       mark as modified
-                        }
-                    }
-                }
-            }
-            erosion_domain.insert(front.begin(), front.end());  // add current front to erosion domain
-            erosion_front = front;                              // advance erosion front
-        }
-
-        m_num_erosion_nodes = static_cast<int>(erosion_domain.size());
-        m_timer_bulldozing_domain.stop();
-
-        // (3) Erosion algorithm on domain
-        m_timer_bulldozing_erosion.start();
-
-        for (int iter = 0; iter < m_erosion_iterations; iter++) {
-            for (const auto& ij : erosion_domain) {
-                auto& nr = m_grid_map.at(ij);
-                for (int k = 0; k < 4; k++) {
-                    ChVector2i nbr_ij = ij + neighbors4[k];
-                    auto rec = m_grid_map.find(nbr_ij);
-                    if (rec == m_grid_map.end())
-                        continue;
-                    auto& nbr_nr = rec->second;
-
-                    // (3.1) Flow remaining material to neighbor
-                    double diff = 0.5 * (nr.massremainder - nbr_nr.massremainder) / 4;  //// TODO: rethink this!
-                    if (diff > 0) {
-                        RemoveMaterialFromNode(diff, nr);
-                        AddMaterialToNode(diff, nbr_nr);
-                    }
+        // Patch boundaries are raised at every step; erosion is performed every m_bulldozing_interval steps
+        bool erosion = (++m_bulldozing_counter >= m_bulldozing_interval);
+        if (erosion)
+            m_bulldozing_counter = 0;
+        std::vector<std::vector<ChVector2i>> patches(contact_patches.size());
+        for (size_t ip = 0; ip < contact_patches.size(); ip++)
+            patches[ip] = std::move(contact_patches[ip].nodes);
+        StartBulldozing(std::move(patches), erosion);
+    } else if (!m_erosion_domain.empty()) {
+        ResetErosionDomain();
+    }
 
-                    // (3.2) Smoothing
-                    if (nbr_nr.sigma == 0) {
-                        double dy = (nr.level + nr.massremainder) - (nbr_nr.level + nbr_nr.massremainder);
-                        diff = 0.5 * (std::abs(dy) - dy_lim) / 4;  //// TODO: rethink this!
-                        if (diff > 0) {
-                            if (dy > 0) {
-                                RemoveMaterialFromNode(diff, nr);
-                                AddMaterialToNode(diff, nbr_nr);
-                            } else {
-                                RemoveMaterialFromNode(diff, nbr_nr);
-                                AddMaterialToNode(diff, nr);
-                            }
-                        }
-                    }
-                }
-            }
-        }
+    // Nodes modified by a deferred bulldozing job may also have been hit in this step
+    UniqueModifiedNodes();
 
-        m_timer_bulldozing_erosion.stop();
+    m_timer_bulldozing.stop();
 
-    }  // end do_bulldozing
+    // -----------------------------------
+    // Exchange data with other subdomains
+    // -----------------------------------
 
-    m_timer_bulldozing.stop();
+    if (m_decomposition) {
+        m_timer_subdomain_exchange.start();
+        ExchangeSubdomains();
+        m_timer_subdomain_exchange.stop();
+    }
 
     // --------------------
     // Update visualization
     // --------------------
 
-    m_timer_visualization.start();
-
-    if (m_trimesh_shape) {
-        // Loop over list of modified nodes and adjust corresponding mesh vertices.
-        // If not rendering a wireframe mesh, also update normals.
-        for (const auto& ij : m_modified_nodes) {
-            if (!CheckMeshBounds(ij))                 // if node outside mesh
-                continue;                             //   do nothing
-            const auto& nr = m_grid_map.at(ij);       // grid node record
-            int iv = GetMeshVertexIndex(ij);          // mesh vertex index
-            UpdateMeshVertexCoordinates(ij, iv, nr);  // update vertex coordinates and color
-            modified_vertices.push_back(iv);          // cache in list of modified mesh vertices
-            if (!m_trimesh_shape->IsWireframe())      // if not wireframe
-                UpdateMeshVertexNormal(ij, iv);       // update vertex normal
-        }
+    // Only record the modified nodes; the mesh is updated when visualization assets are requested.
+    if (m_trimesh_shape || m_heightfield || m_traversability) {
+        for (const auto& ij : m_modified_nodes)
+            MarkVisualizationNode(ij);
+    }
 
-        m_trimesh_shape->SetModifiedVertices(modified_vertices);
+    // Publish the terrain state at the end of this step for concurrent readers
+    if (m_state_snapshots) {
+        MarkSnapshotNodes(m_modified_nodes);
+        PublishStateSnapshot();
     }
 
-    m_timer_visualization.stop();
+    // Record the nodes modified over this step
+    if (m_recorder)
+        RecordStep();
 }
 
-void SCMLoaderOld::AddMaterialToNode(double amount, NodeRecord& nr) {
+double SCMLoaderOld::AddMaterialToNode(double amount, NodeRecord& nr) {
     if (amount > nr.hit_level - nr.level) {                      //   if not possible to assign all mass
         nr.massremainder += amount - (nr.hit_level - nr.level);  //     material to be further propagated
         amount = nr.hit_level - nr.level;                        //     clamp raise amount
     }                                                            //
     nr.level += amount;                                          //   modify node level
     nr.level_initial += amount;                                  //   reset node initial level
+    return amount;
 }
 
-void SCMLoaderOld::RemoveMaterialFromNode(double amount, NodeRecord& nr) {
+double SCMLoaderOld::RemoveMaterialFromNode(double amount, NodeRecord& nr) {
     if (nr.massremainder > amount) {                                 // if too much remainder material
         nr.massremainder -= amount;                                  //   decrease remainder material
         /*amount = 0;*/                                              //   ???
@@ -1733,132 +2556,3101 @@ void SCMLoaderOld::RemoveMaterialFromNode(double amount, NodeRecord& nr) {
     }                                                                //
     nr.level -= amount;                                              //   modify node level
     nr.level_initial -= amount;                                      //   reset node initial level
+    return amount;
 }
 
-// Update vertex position and color in visualization mesh
-void SCMLoaderOld::UpdateMeshVertexCoordinates(const ChVector2i ij, int iv, const NodeRecord& nr) {
-    auto& trimesh = *m_trimesh_shape->GetMesh();
-    std::vector<ChVector3d>& vertices = trimesh.GetCoordsVertices();
-    std::vector<ChColor>& colors = trimesh.GetCoordsColors();
+// -----------------------------------------------------------------------------
+// Bulldozing
+// -----------------------------------------------------------------------------
 
-    // Update visualization mesh vertex position
-    vertices[iv] = m_frame.TransformPointLocalToParent(ChVector3d(ij.x() * m_delta, ij.y() * m_delta, nr.level));
+// Direct access to the grid map (synchronous bulldozing).
+class SCMLoaderOld::GridDirect {
+  public:
+    GridDirect(SCMLoaderOld& loader) : m_loader(loader), m_map(loader.m_grid_map) {}
 
-    // Update visualization mesh vertex color
-    if (m_plot_type != SCMTerrainOld::PLOT_NONE) {
-        ChColor color;
-        switch (m_plot_type) {
-            case SCMTerrainOld::PLOT_LEVEL:
-                color = m_colormap->Get(nr.level, m_plot_v_min, m_plot_v_max);
-                break;
-            case SCMTerrainOld::PLOT_LEVEL_INITIAL:
-                color = m_colormap->Get(nr.level_initial, m_plot_v_min, m_plot_v_max);
-                break;
-            case SCMTerrainOld::PLOT_SINKAGE:
-                color = m_colormap->Get(nr.sinkage, m_plot_v_min, m_plot_v_max);
-                break;
-            case SCMTerrainOld::PLOT_SINKAGE_ELASTIC:
-                color = m_colormap->Get(nr.sinkage_elastic, m_plot_v_min, m_plot_v_max);
-                break;
-            case SCMTerrainOld::PLOT_SINKAGE_PLASTIC:
-                color = m_colormap->Get(nr.sinkage_plastic, m_plot_v_min, m_plot_v_max);
-                break;
-            case SCMTerrainOld::PLOT_STEP_PLASTIC_FLOW:
-                color = m_colormap->Get(nr.step_plastic_flow, m_plot_v_min, m_plot_v_max);
-                break;
-            case SCMTerrainOld::PLOT_K_JANOSI:
-                color = m_colormap->Get(nr.kshear, m_plot_v_min, m_plot_v_max);
-                break;
-            case SCMTerrainOld::PLOT_PRESSURE:
-                color = m_colormap->Get(nr.sigma, m_plot_v_min, m_plot_v_max);
-                break;
-            case SCMTerrainOld::PLOT_PRESSURE_YIELD:
-                color = m_colormap->Get(nr.sigma_yield, m_plot_v_min, m_plot_v_max);
-                break;
-            case SCMTerrainOld::PLOT_SHEAR:
-                color = m_colormap->Get(nr.tau, m_plot_v_min, m_plot_v_max);
-                break;
-            case SCMTerrainOld::PLOT_MASSREMAINDER:
-                color = m_colormap->Get(nr.massremainder, m_plot_v_min, m_plot_v_max);
-                break;
-            case SCMTerrainOld::PLOT_ISLAND_ID:
-                if (nr.erosion)
-                    color = ChColor(0, 0, 0);
-                if (nr.sigma > 0)
-                    color = ChColor(1, 0, 0);
-                break;
-            case SCMTerrainOld::PLOT_IS_TOUCHED:
-                if (nr.sigma > 0)
-                    color = ChColor(1, 0, 0);
-                else
-                    color = ChColor(0, 0, 1);
-                break;
-            case SCMTerrainOld::PLOT_NONE:
-                break;
-        }
-        colors[iv] = color;
-    }
-}
-
-// Update vertex normal in visualization mesh.
-void SCMLoaderOld::UpdateMeshVertexNormal(const ChVector2i ij, int iv) {
-    auto& trimesh = *m_trimesh_shape->GetMesh();
-    std::vector<ChVector3d>& vertices = trimesh.GetCoordsVertices();
-    std::vector<ChVector3d>& normals = trimesh.GetCoordsNormals();
-    std::vector<ChVector3i>& idx_normals = trimesh.GetIndicesNormals();
+    // Read-only lookup (nullptr if the node was not yet recorded).
+    const NodeRecord* Peek(const ChVector2i& ij) const {
+        auto rec = m_map.find(ij);
+        return rec == m_map.end() ? nullptr : &rec->second;
+    }
 
-    // Average normals from adjacent faces
-    normals[iv] = ChVector3d(0, 0, 0);
-    auto faces = GetMeshFaceIndices(ij);
-    for (auto f : faces) {
-        ChVector3d nrm = Vcross(vertices[idx_normals[f][1]] - vertices[idx_normals[f][0]],
-                                vertices[idx_normals[f][2]] - vertices[idx_normals[f][0]]);
-        nrm.Normalize();
-        normals[iv] += nrm;
+    // Lookup for modification (nullptr if the node was not yet recorded).
+    NodeRecord* Find(const ChVector2i& ij) {
+        auto rec = m_map.find(ij);
+        if (rec == m_map.end())
+            return nullptr;
+        m_loader.MarkCheckpointNode(ij);
+        return &rec->second;
+    }
+
+    // Lookup for modification (a record for the undeformed terrain is created if needed).
+    NodeRecord& Get(const ChVector2i& ij) {
+        auto rec = m_map.find(ij);
+        if (rec == m_map.end()) {
+            double z = m_loader.GetInitHeight(ij);
+            rec = m_map.insert(std::make_pair(ij, NodeRecord(z, z, m_loader.GetInitNormal(ij)))).first;
+            m_loader.IndexNode(ij);
+        } else {
+            m_loader.MarkCheckpointNode(ij);
+        }
+        return rec->second;
+    }
+
+  private:
+    SCMLoaderOld& m_loader;
+    std::unordered_map<ChVector2i, NodeRecord, CoordHash>& m_map;
+};
+
+// Copy-on-access overlay of the grid map (deferred bulldozing).
+// The grid map is only read, so that it can be shared with other readers while bulldozing runs in the background.
+// Node records are copied in the overlay the first time they are accessed for modification.
+class SCMLoaderOld::GridOverlay {
+  public:
+    GridOverlay(SCMLoaderOld& loader, std::unordered_map<ChVector2i, NodeRecord, CoordHash>& overlay)
+        : m_loader(loader), m_map(loader.m_grid_map), m_overlay(overlay) {}
+
+    // Read-only lookup (nullptr if the node was not yet recorded).
+    const NodeRecord* Peek(const ChVector2i& ij) const {
+        auto rec = m_overlay.find(ij);
+        if (rec != m_overlay.end())
+            return &rec->second;
+        auto base = m_map.find(ij);
+        return base == m_map.end() ? nullptr : &base->second;
+    }
+
+    // Lookup for modification (nullptr if the node was not yet recorded).
+    NodeRecord* Find(const ChVector2i& ij) {
+        auto rec = m_overlay.find(ij);
+        if (rec != m_overlay.end())
+            return &rec->second;
+        auto base = m_map.find(ij);
+        if (base == m_map.end())
+            return nullptr;
+        return &m_overlay.insert(*base).first->second;
+    }
+
+    // Lookup for modification (a record for the undeformed terrain is created if needed).
+    NodeRecord& Get(const ChVector2i& ij) {
+        if (auto nr = Find(ij))
+            return *nr;
+        double z = m_loader.GetInitHeight(ij);
+        return m_overlay.insert(std::make_pair(ij, NodeRecord(z, z, m_loader.GetInitNormal(ij)))).first->second;
+    }
+
+  private:
+    const SCMLoaderOld& m_loader;
+    const std::unordered_map<ChVector2i, NodeRecord, CoordHash>& m_map;
+    std::unordered_map<ChVector2i, NodeRecord, CoordHash>& m_overlay;
+};
+
+// Flow material to the side of ruts, using heuristics.
+// All grid accesses go through the provided grid accessor (direct or overlay).
+// If 'erosion = false', only raise the patch boundaries (the displaced material is smoothed out at a later step).
+template <class Grid>
+void SCMLoaderOld::DoBulldozing(Grid& grid, BulldozingJob& job, bool erosion) {
+    const int nthreads = job.nthreads;
+    const auto& patches = job.patches;
+
+    // Maximum level change between neighboring nodes (smoothing phase)
+    double dy_lim = m_delta * job.erosion_slope;
+
+    // With domain decomposition, ghost nodes are updated by their owner: they are neither part of the effective contact
+    // patches nor erosion targets, and their share of the raised material is sent to the owner
+    auto ghost = [this, &job](const ChVector2i& ij) { return job.rank >= 0 && GetSubdomain(ij) != job.rank; };
+
+    // (1) Raise boundaries of each contact patch.
+    // Patch boundaries are extracted in parallel (read-only access to the grid map). Boundary nodes shared by
+    // several patches receive the raise amounts from all of them, merged in grid order before being applied.
+    job.timer_boundary.start();
+
+    int num_patches = static_cast<int>(patches.size());
+    std::vector<std::vector<ChVector2i>> p_boundaries(num_patches);  // boundaries of effective contact patches
+    std::vector<std::vector<ChVector2i>> p_touched(num_patches);     // effective contact patches
+    std::vector<double> p_raise(num_patches);                        // raise amount for each patch boundary
+    std::vector<double> p_flow(num_patches);                         // displaced material from each patch
+
+#pragma omp parallel for num_threads(nthreads)
+    for (int ip = 0; ip < num_patches; ip++) {
+        auto& p_boundary = p_boundaries[ip];
+
+        // Calculate the displaced material from all touched nodes and identify boundary
+        double tot_step_flow = 0;
+        for (const auto& ij : patches[ip]) {             // for each node in contact patch
+            const auto& nr = *grid.Peek(ij);             //   get node record
+            if (nr.sigma <= 0 || ghost(ij))              //   if node not touched (or not owned)
+                continue;                                //     skip (not in effective patch)
+            p_touched[ip].push_back(ij);                 //   add to effective patch
+            tot_step_flow += nr.step_plastic_flow;       //   accumulate displaced material
+            for (int k = 0; k < 4; k++) {                //   check each node neighbor
+                ChVector2i nbr_ij = ij + neighbors4[k];  //     neighbor node coordinates
+                ////if (!CheckMeshBounds(nbr_ij))                     //     if neighbor out of bounds
+                ////    continue;                                     //       skip neighbor
+                auto nbr = grid.Peek(nbr_ij);                //     neighbor record
+                if (!nbr || nbr->sigma <= 0)                 //     if not yet recorded or not touched
+                    p_boundary.push_back(nbr_ij);            //       set neighbor as boundary
+            }
+        }
+        tot_step_flow *= job.step;
+        p_flow[ip] = tot_step_flow;
+
+        // Remove duplicate boundary nodes
+        std::sort(p_boundary.begin(), p_boundary.end(), CoordLess());
+        p_boundary.erase(std::unique(p_boundary.begin(), p_boundary.end()), p_boundary.end());
+
+        // Target raise amount for each boundary node (unless clamped)
+        p_raise[ip] = job.flow_factor * tot_step_flow / p_boundary.size();
+    }
+
+    // Merge patch boundaries (in grid order, then patch order)
+    std::vector<std::pair<ChVector2i, double>> raise;
+    for (int ip = 0; ip < num_patches; ip++) {
+        job.displaced += p_flow[ip];
+        for (const auto& ij : p_boundaries[ip])
+            raise.push_back(std::make_pair(ij, p_raise[ip]));
+    }
+    std::stable_sort(raise.begin(), raise.end(),
+                     [](const std::pair<ChVector2i, double>& a, const std::pair<ChVector2i, double>& b) {
+                         return CoordLess()(a.first, b.first);
+                     });
+
+    // Raise boundary (create a sharp spike which will be later smoothed out with erosion).
+    // Boundary nodes are marked as modified together with the rest of the erosion domain.
+    NodeSet boundary;  // union of contact patch boundaries
+    boundary.reserve(raise.size());
+    for (size_t k = 0; k < raise.size();) {                      // for each node in bndry
+        ChVector2i ij = raise[k].first;                          //
+        double diff = 0;                                         //
+        for (; k < raise.size() && raise[k].first == ij; k++)    //   accumulate raise amounts
+            diff += raise[k].second;                             //   from all adjacent patches
+        if (ghost(ij)) {                                         //   if node not owned
+            job.remote.push_back(std::make_pair(ij, diff));      //     send raise amount to owner
+            continue;                                            //
+        }                                                        //
+        job.deposited += AddMaterialToNode(diff, grid.Get(ij));  //   add raise amount (create record if needed)
+        boundary.insert(ij);                                     //   accumulate boundary
+    }
+
+    job.timer_boundary.stop();
+
+    if (!erosion) {
+        job.modified.insert(job.modified.end(), boundary.begin(), boundary.end());
+        job.pending = true;
+        return;
+    }
+
+    NodeSet touched;  // union of effective contact patches
+    for (int ip = 0; ip < num_patches; ip++)
+        touched.insert(p_touched[ip].begin(), p_touched[ip].end());
+
+    // (2) Update erosion domain (dilate boundary, incrementally from the domain at previous step)
+    job.timer_domain.start();
+
+    UpdateErosionDomain(grid, job, boundary, touched);
+
+    job.num_erosion_nodes = static_cast<int>(job.domain.size());
+    job.timer_domain.stop();
+
+    // (3) Erosion algorithm on domain
+    job.timer_erosion.start();
+
+    for (const auto& ij : job.domain) {
+        if (!ghost(ij))
+            job.modified.push_back(ij);
+    }
+
+    NodeSet spilled;  // nodes outside the erosion domain modified by the erosion (listed once)
+    for (int iter = 0; iter < job.erosion_iterations; iter++) {
+        for (const auto& ij : job.domain) {
+            if (ghost(ij))
+                continue;
+            auto& nr = grid.Get(ij);
+            for (int k = 0; k < 4; k++) {
+                ChVector2i nbr_ij = ij + neighbors4[k];
+                if (ghost(nbr_ij))
+                    continue;
+                auto rec = grid.Find(nbr_ij);
+                if (!rec)
+                    continue;
+                auto& nbr_nr = *rec;
+                double nbr_level = nbr_nr.level;
+
+                // (3.1) Flow remaining material to neighbor
+                double diff = 0.5 * (nr.massremainder - nbr_nr.massremainder) / 4;  //// TODO: rethink this!
+                if (diff > 0) {
+                    job.deposited -= RemoveMaterialFromNode(diff, nr);
+                    job.deposited += AddMaterialToNode(diff, nbr_nr);
+                }
+
+                // (3.2) Smoothing
+                if (nbr_nr.sigma == 0) {
+                    double dy = (nr.level + nr.massremainder) - (nbr_nr.level + nbr_nr.massremainder);
+                    diff = 0.5 * (std::abs(dy) - dy_lim) / 4;  //// TODO: rethink this!
+                    if (diff > 0) {
+                        if (dy > 0) {
+                            job.deposited -= RemoveMaterialFromNode(diff, nr);
+                            job.deposited += AddMaterialToNode(diff, nbr_nr);
+                        } else {
+                            job.deposited -= RemoveMaterialFromNode(diff, nbr_nr);
+                            job.deposited += AddMaterialToNode(diff, nr);
+                        }
+                    }
+                }
+
+                // Neighbors outside the erosion domain are also modified
+                if (nbr_nr.level != nbr_level && nbr_nr.erosion_hops < 0)
+                    spilled.insert(nbr_ij);
+            }
+        }
     }
-    normals[iv] /= (double)faces.size();
+    job.modified.insert(job.modified.end(), spilled.begin(), spilled.end());
+
+    job.timer_erosion.stop();
+    job.pending = true;
 }
 
-// Get the heights of modified grid nodes.
-std::vector<SCMTerrainOld::NodeLevel> SCMLoaderOld::GetModifiedNodes(bool all_nodes) const {
-    std::vector<SCMTerrainOld::NodeLevel> nodes;
-    if (all_nodes) {
-        for (const auto& nr : m_grid_map) {
-            nodes.push_back(std::make_pair(nr.first, nr.second.level));
+// Incrementally update the erosion domain (all untouched nodes within job.erosion_propagations hops of the union of
+// contact patch boundaries). Each domain node caches its hop distance to the boundary. Between consecutive steps,
+// only nodes affected by a change in the boundary or in the set of touched nodes are revisited:
+//   (a) nodes that lost their support (a neighbor one hop closer to the boundary) are invalidated, in increasing
+//       order of their previous distance;
+//   (b) distances are then relaxed, in increasing order, starting from new boundary nodes, from invalidated nodes,
+//       and from nodes released from the contact patches.
+// For a steadily moving contact patch, this is proportional to the change in footprint, not the domain size.
+template <class Grid>
+void SCMLoaderOld::UpdateErosionDomain(Grid& grid,
+                                       BulldozingJob& job,
+                                       const NodeSet& boundary,
+                                       const NodeSet& touched) {
+    const int max_hops = std::max(job.erosion_propagations, 0);
+    std::vector<std::vector<ChVector2i>> buckets(max_hops + 1);
+
+    // (a) Invalidation of nodes that lost support
+    for (const auto& ij : job.boundary) {                 // for each boundary node at previous step
+        if (boundary.find(ij) == boundary.end())          //   if no longer a boundary node
+            buckets[0].push_back(ij);                     //     lost its support
+    }                                                     //
+    for (const auto& ij : touched) {                      // for each currently touched node
+        if (job.touched.find(ij) != job.touched.end())    //   if touched at previous step
+            continue;                                     //     not previously in domain
+        const auto& nr = *grid.Peek(ij);                  //   node record
+        if (nr.erosion_hops >= 0)                         //   if previously in domain
+            buckets[nr.erosion_hops].push_back(ij);       //     must be removed from domain
+    }
+
+    std::vector<ChVector2i> invalidated;
+    for (int h = 0; h <= max_hops; h++) {
+        for (const auto& ij : buckets[h]) {
+            if (grid.Peek(ij)->erosion_hops != h)  // already processed
+                continue;
+            auto& nr = grid.Get(ij);
+            // A node is still supported if it is not touched and it has a valid neighbor one hop closer
+            bool supported = false;
+            if (h > 0 && nr.sigma <= 0) {
+                for (int k = 0; k < 4 && !supported; k++) {
+                    auto rec = grid.Peek(ij + neighbors4[k]);
+                    supported = (rec && rec->erosion_hops == h - 1);
+                }
+            }
+            if (supported)
+                continue;
+            nr.erosion_hops = -1;
+            nr.erosion = false;
+            invalidated.push_back(ij);
+            if (h == max_hops)
+                continue;
+            for (int k = 0; k < 4; k++) {
+                ChVector2i nbr_ij = ij + neighbors4[k];
+                auto rec = grid.Peek(nbr_ij);
+                if (rec && rec->erosion_hops == h + 1)
+                    buckets[h + 1].push_back(nbr_ij);
+            }
         }
-    } else {
-        for (const auto& ij : m_modified_nodes) {
-            auto rec = m_grid_map.find(ij);
-            assert(rec != m_grid_map.end());
-            nodes.push_back(std::make_pair(ij, rec->second.level));
+        buckets[h].clear();
+    }
+
+    // (b) Relaxation of distances
+    auto relax = [&](const ChVector2i& ij, NodeRecord& nr, int h) {
+        if (nr.erosion_hops >= 0 && nr.erosion_hops <= h)
+            return;
+        if (nr.erosion_hops < 0)
+            job.domain.insert(ij);
+        nr.erosion_hops = h;
+        nr.erosion = true;
+        buckets[h].push_back(ij);
+    };
+
+    // Candidate node, with distance given by its neighbors (touched nodes are never in the domain)
+    auto reseed = [&](const ChVector2i& ij) {
+        if (grid.Peek(ij)->sigma > 0)
+            return;
+        int h = max_hops + 1;
+        for (int k = 0; k < 4; k++) {
+            auto rec = grid.Peek(ij + neighbors4[k]);
+            if (rec && rec->erosion_hops >= 0)
+                h = std::min(h, rec->erosion_hops + 1);
         }
+        if (h <= max_hops)
+            relax(ij, grid.Get(ij), h);
+    };
+
+    for (const auto& ij : boundary)             // boundary nodes are at distance 0
+        relax(ij, grid.Get(ij), 0);             //
+    for (const auto& ij : invalidated)          // nodes invalidated above
+        reseed(ij);                             //
+    for (const auto& ij : job.touched) {        // nodes released from contact patches
+        if (touched.find(ij) == touched.end())  //
+            reseed(ij);                         //
     }
-    return nodes;
+
+    for (int h = 0; h < max_hops; h++) {
+        for (size_t n = 0; n < buckets[h].size(); n++) {
+            ChVector2i ij = buckets[h][n];
+            if (grid.Peek(ij)->erosion_hops != h)  // already improved
+                continue;
+            for (int k = 0; k < 4; k++) {
+                ChVector2i nbr_ij = ij + neighbors4[k];
+                auto rec = grid.Peek(nbr_ij);
+                if (rec && rec->sigma > 0)  // touched nodes are never in the domain
+                    continue;
+                relax(nbr_ij, grid.Get(nbr_ij), h + 1);  // create record if needed
+            }
+        }
+    }
+
+    // Remove from the domain all invalidated nodes that were not reached again
+    for (const auto& ij : invalidated) {
+        if (grid.Peek(ij)->erosion_hops < 0)
+            job.domain.erase(ij);
+    }
+
+    job.boundary = boundary;
+    job.touched = touched;
 }
 
-// Modify the level of grid nodes from the given list.
-// NOTE: We set only the level of the specified nodes and none of the other soil properties.
-//       As such, some plot types may be incorrect at these nodes.
-void SCMLoaderOld::SetModifiedNodes(const std::vector<SCMTerrain::NodeLevel>& nodes) {
-    for (const auto& n : nodes) {
-        // Modify existing entry in grid map or insert new one
-        m_grid_map[n.first] = SCMLoaderOld::NodeRecord(n.second, n.second, GetInitNormal(n.first));
+// Discard the current erosion domain.
+void SCMLoaderOld::ResetErosionDomain() {
+    WaitBulldozing();
+    FinishBulldozing();
+
+    for (const auto& ij : m_erosion_domain) {
+        auto rec = m_grid_map.find(ij);
+        if (rec != m_grid_map.end()) {
+            MarkCheckpointNode(ij);
+            rec->second.erosion = false;
+            rec->second.erosion_hops = -1;
+        }
     }
+    m_erosion_domain.clear();
+    m_erosion_boundary.clear();
+    m_erosion_touched.clear();
+}
 
-    // Update visualization
-    if (m_trimesh_shape) {
-        for (const auto& n : nodes) {
-            auto ij = n.first;                           // grid location
-            if (!CheckMeshBounds(ij))                    // if outside mesh
-                continue;                                //   do nothing
-            const auto& nr = m_grid_map.at(ij);          // grid node record
-            int iv = GetMeshVertexIndex(ij);             // mesh vertex index
-            UpdateMeshVertexCoordinates(ij, iv, nr);     // update vertex coordinates and color
-            if (!m_trimesh_shape->IsWireframe())         // if not in wireframe mode
-                UpdateMeshVertexNormal(ij, iv);          //   update vertex normal
-            m_external_modified_vertices.push_back(iv);  // cache in list
+// Perform bulldozing for the given contact patches, either immediately or as a deferred job on a background thread.
+// Only jobs that include erosion are deferred.
+void SCMLoaderOld::StartBulldozing(std::vector<std::vector<ChVector2i>>&& patches, bool erosion) {
+    auto& job = m_bulldozing_job;
+    job.patches = std::move(patches);
+    job.nodes.clear();
+    job.modified.clear();
+    job.num_erosion_nodes = 0;
+    job.displaced = 0;
+    job.deposited = 0;
+    job.timer_boundary.reset();
+    job.timer_domain.reset();
+    job.timer_erosion.reset();
+    job.pending = false;
+
+    // Snapshot of the parameters (may be changed between steps while a deferred job runs)
+    job.flow_factor = m_flow_factor;
+    job.erosion_slope = m_erosion_slope;
+    job.erosion_iterations = m_erosion_iterations;
+    job.erosion_propagations = m_erosion_propagations;
+    job.step = GetSystem()->GetStep();
+    job.nthreads = GetSystem()->GetNumThreadsChrono();
+    job.rank = m_decomposition ? m_decomposition->rank : -1;
+    job.remote.clear();
+
+    // The job owns the erosion domain until it completes
+    SwapErosionDomain(job);
+
+    if (!m_bulldozing_async || !erosion) {
+        GridDirect grid(*this);
+        DoBulldozing(grid, job, erosion);
+        SwapErosionDomain(job);
+        FinishBulldozing();
+        return;
+    }
+
+    // The deferred job only reads the grid map; all modifications are recorded in the job overlay
+    m_bulldozing_future = std::async(std::launch::async, [this]() {
+        GridOverlay grid(*this, m_bulldozing_job.nodes);
+        DoBulldozing(grid, m_bulldozing_job, true);
+    });
+}
+
+// Exchange the erosion domain state between the loader and the bulldozing job.
+void SCMLoaderOld::SwapErosionDomain(BulldozingJob& job) {
+    std::swap(m_erosion_domain, job.domain);
+    std::swap(m_erosion_boundary, job.boundary);
+    std::swap(m_erosion_touched, job.touched);
+}
+
+// Wait for completion of a deferred bulldozing job (if any) and merge the modified node records into the grid map.
+// Only quantities changed by bulldozing are merged.
+void SCMLoaderOld::WaitBulldozing() {
+    if (!m_bulldozing_future.valid())
+        return;
+    m_bulldozing_future.get();
+
+    for (const auto& n : m_bulldozing_job.nodes) {
+        auto rec = m_grid_map.find(n.first);
+        if (rec == m_grid_map.end()) {
+            m_grid_map.insert(n);
+            IndexNode(n.first);
+            continue;
+        }
+        MarkCheckpointNode(n.first);
+        auto& nr = rec->second;
+        nr.level = n.second.level;
+        nr.level_initial = n.second.level_initial;
+        nr.massremainder = n.second.massremainder;
+        nr.erosion = n.second.erosion;
+        nr.erosion_hops = n.second.erosion_hops;
+    }
+    m_bulldozing_job.nodes.clear();
+
+    // Take back the erosion domain updated by the job
+    SwapErosionDomain(m_bulldozing_job);
+
+    // Apply the data received from other subdomains while the job was running
+    if (m_decomposition)
+        ApplySubdomainExchange();
+}
+
+// Collect the modified nodes and statistics of the last completed bulldozing job.
+void SCMLoaderOld::FinishBulldozing() {
+    auto& job = m_bulldozing_job;
+    if (!job.pending)
+        return;
+    m_modified_nodes.insert(m_modified_nodes.end(), job.modified.begin(), job.modified.end());
+    UniqueModifiedNodes();
+    m_num_erosion_nodes = job.num_erosion_nodes;
+    m_stats.displaced_volume += job.displaced * m_area;
+    m_stats.deposited_volume += job.deposited * m_area;
+    m_stats.net_volume += job.deposited * m_area;
+    m_timer_bulldozing_boundary = job.timer_boundary;
+    m_timer_bulldozing_domain = job.timer_domain;
+    m_timer_bulldozing_erosion = job.timer_erosion;
+    if (m_decomposition)
+        m_decomposition->raised.insert(m_decomposition->raised.end(), job.remote.begin(), job.remote.end());
+    job.modified.clear();
+    job.remote.clear();
+    job.pending = false;
+}
+
+// Flag the given grid node for the next visualization update (mesh vertex and heightfield texel).
+void SCMLoaderOld::MarkVisualizationNode(const ChVector2i& ij) {
+    if (!CheckMeshBounds(ij))
+        return;
+
+    if (m_trimesh_shape)
+        MarkMeshVertex(ij);
+
+    // If the traversability map is not yet created, it will be filled completely at the next update.
+    if (m_traversability && !m_traversability->dirty.empty())
+        MarkTraversabilityNode(ij);
+
+    // Heightfield texels use the same layout as the vertices of the (single) visualization mesh.
+    // If the textures are not yet created, they will be filled completely at the next update.
+    if (m_heightfield && !m_heightfield->dirty.empty()) {
+        int it = GetMeshVertexIndex(ij);
+        if (!m_heightfield->dirty[it]) {
+            m_heightfield->dirty[it] = true;
+            m_heightfield->texels.push_back(it);
+        }
+    }
+}
+
+// Flag the visualization mesh vertex at the given grid node (if any) for the next visualization update.
+void SCMLoaderOld::MarkMeshVertex(const ChVector2i& ij) {
+    if (!CheckMeshBounds(ij))
+        return;
+    if (!m_mesh_tiles.empty()) {
+        MarkMeshTileVertex(ij);
+        return;
+    }
+    int iv = GetMeshVertexIndex(ij);
+    if (!m_vis_dirty[iv]) {
+        m_vis_dirty[iv] = true;
+        m_vis_vertices.push_back(iv);
+    }
+}
+
+// Update the visualization mesh and heightfield textures at all nodes modified since the last update.
+void SCMLoaderOld::UpdateVisualization() {
+    // A tiled mesh may change level of detail even if no vertices were modified.
+    // The initial snapshot of the (single) mesh and the initial textures must be created on the first update.
+    bool update_mesh = m_trimesh_shape && (!m_mesh_tiles.empty() || !m_vis_vertices.empty() ||
+                                           (m_vis_snapshots && m_vis_snapshots->published.load() == 0));
+    bool update_texture = m_heightfield && (m_heightfield->width == 0 || !m_heightfield->texels.empty());
+
+    if (!update_mesh && !update_texture)
+        return;
+
+    m_timer_visualization.start();
+
+    if (update_texture)
+        UpdateHeightfield();
+
+    if (update_mesh) {
+        if (m_mesh_tiles.empty())
+            UpdateMesh();
+        else
+            UpdateMeshTiles();
+    }
+
+    m_timer_visualization.stop();
+}
+
+// Update the (single) visualization mesh at all vertices modified since the last update.
+// Each modified vertex is processed once, in increasing index order. Vertex coordinates and colors are updated first,
+// so that normals are evaluated on the current mesh.
+void SCMLoaderOld::UpdateMesh() {
+    // Publish an initial snapshot of the complete mesh
+    if (m_vis_snapshots && m_vis_snapshots->published.load() == 0)
+        PublishMeshSnapshot(m_vis_vertices);
+
+    if (m_vis_vertices.empty())
+        return;
+
+    std::sort(m_vis_vertices.begin(), m_vis_vertices.end());
+
+    auto& trimesh = *m_trimesh_shape->GetMesh();
+    int nvx = 2 * m_nx + 1;  // number of grid vertices in X direction
+    int nvy = 2 * m_ny + 1;  // number of grid vertices in Y direction
+
+    m_vis_records.clear();
+    for (int iv : m_vis_vertices) {
+        ChVector2i ij(iv % nvx - m_nx, iv / nvx - m_ny);   // grid location
+        const auto& nr = m_grid_map.at(ij);              // grid node record
+        UpdateMeshVertexCoordinates(trimesh, ij, iv, nr);  // update vertex coordinates
+        m_vis_records.push_back(&nr);                    // cache node record for coloring
+        m_vis_dirty[iv] = false;                         // reset vertex flag
+    }
+
+    // Update vertex colors (single pass over all modified vertices)
+    if (m_plot_type != SCMTerrainOld::PLOT_NONE)
+        UpdateMeshVertexColors(trimesh, m_vis_vertices, m_vis_records);
+
+    // If not rendering a wireframe mesh, also update normals
+    if (!m_trimesh_shape->IsWireframe())
+        UpdateMeshNormals(trimesh, nvx, nvy, m_vis_vertices);
+
+    m_trimesh_shape->SetModifiedVertices(m_vis_vertices);
+
+    if (m_vis_snapshots)
+        PublishMeshSnapshot(m_vis_vertices);
+
+    m_vis_vertices.clear();
+}
+
+// Update the heightfield textures at all modified texels and flag the corresponding blocks.
+// The first update creates the textures and flags all blocks.
+void SCMLoaderOld::UpdateHeightfield() {
+    auto& hf = *m_heightfield;
+    const int block = HeightfieldTexture::block;
+
+    // Create textures (all grid nodes)
+    if (hf.width == 0) {
+        hf.width = 2 * m_nx + 1;
+        hf.height = 2 * m_ny + 1;
+        hf.heights.resize(hf.width * hf.height);
+        hf.values.resize(hf.width * hf.height);
+        hf.dirty.assign(hf.width * hf.height, false);
+        hf.blocks.assign(((hf.width + block - 1) / block) * ((hf.height + block - 1) / block), true);
+        hf.texels.clear();
+        for (int it = 0; it < hf.width * hf.height; it++) {
+            ChVector2i ij(it % hf.width - m_nx, it / hf.width - m_ny);
+            auto rec = m_grid_map.find(ij);
+            if (rec != m_grid_map.end()) {
+                hf.heights[it] = static_cast<float>(rec->second.level);
+                hf.values[it] = static_cast<float>(GetPlotValue(rec->second));
+            } else {
+                double z = GetInitHeight(ij);
+                hf.heights[it] = static_cast<float>(z);
+                hf.values[it] = static_cast<float>(GetPlotValue(NodeRecord(z, z, GetInitNormal(ij))));
+            }
+        }
+        return;
+    }
+
+    // Update modified texels
+    int nbx = (hf.width + block - 1) / block;
+    for (int it : hf.texels) {
+        ChVector2i ij(it % hf.width - m_nx, it / hf.width - m_ny);
+        const auto& nr = m_grid_map.at(ij);
+        hf.heights[it] = static_cast<float>(nr.level);
+        hf.values[it] = static_cast<float>(GetPlotValue(nr));
+        hf.dirty[it] = false;
+        hf.blocks[(it % hf.width) / block + nbx * ((it / hf.width) / block)] = true;
+    }
+    hf.texels.clear();
+}
+
+// Flag the traversability map cells affected by the given grid node.
+// Besides the cell containing the node, slopes at the previous node in X and Y direction (which may belong to the
+// adjacent cells) depend on the node level.
+void SCMLoaderOld::MarkTraversabilityNode(const ChVector2i& ij) {
+    auto& tm = *m_traversability;
+    int a = ij.x() + m_nx;  // node offset from lower-left grid corner
+    int b = ij.y() + m_ny;
+    int cx = a / tm.cell_nodes;
+    int cy = b / tm.cell_nodes;
+
+    auto mark = [&tm](int ic) {
+        if (!tm.dirty[ic]) {
+            tm.dirty[ic] = true;
+            tm.modified.push_back(ic);
         }
+    };
+
+    mark(cx + tm.width * cy);
+    if (cx > 0 && a % tm.cell_nodes == 0)
+        mark(cx - 1 + tm.width * cy);
+    if (cy > 0 && b % tm.cell_nodes == 0)
+        mark(cx + tm.width * (cy - 1));
+}
+
+// Update the traversability map at all modified cells.
+// The first update creates the map and summarizes all cells.
+void SCMLoaderOld::UpdateTraversabilityMap() const {
+    if (!m_traversability)
+        return;
+    auto& tm = *m_traversability;
+
+    // Create map (all grid nodes)
+    if (tm.width == 0) {
+        tm.cell_nodes = std::max(1, static_cast<int>(std::round(tm.cell_size / m_delta)));
+        tm.width = (2 * m_nx + tm.cell_nodes) / tm.cell_nodes;
+        tm.height = (2 * m_ny + tm.cell_nodes) / tm.cell_nodes;
+        tm.cells.resize(tm.width * tm.height);
+        tm.dirty.assign(tm.width * tm.height, true);
+        tm.modified.resize(tm.width * tm.height);
+        for (int ic = 0; ic < tm.width * tm.height; ic++)
+            tm.modified[ic] = ic;
+    }
+
+    for (int ic : tm.modified) {
+        UpdateTraversabilityCell(ic);
+        tm.dirty[ic] = false;
+    }
+    tm.modified.clear();
+}
+
+// Recompute the summary of the given traversability map cell.
+// Levels of the cell nodes, plus one more row and column for the forward differences, are gathered first so that each
+// node is looked up once.
+void SCMLoaderOld::UpdateTraversabilityCell(int ic) const {
+    auto& tm = *m_traversability;
+    int i0 = (ic % tm.width) * tm.cell_nodes - m_nx;  // first cell node
+    int j0 = (ic / tm.width) * tm.cell_nodes - m_ny;
+    int i1 = std::min(i0 + tm.cell_nodes - 1, m_nx);  // last cell node
+    int j1 = std::min(j0 + tm.cell_nodes - 1, m_ny);
+    int i2 = std::min(i1 + 1, m_nx);                  // last gathered node
+    int j2 = std::min(j1 + 1, m_ny);
+    int ni = i2 - i0 + 1;
+
+    double sinkage_max = 0;
+    tm.levels.resize(ni * (j2 - j0 + 1));
+    for (int j = j0; j <= j2; j++) {
+        for (int i = i0; i <= i2; i++) {
+            ChVector2i ij(i, j);
+            auto rec = m_grid_map.find(ij);
+            if (rec == m_grid_map.end()) {
+                tm.levels[(i - i0) + ni * (j - j0)] = GetInitHeight(ij);
+                continue;
+            }
+            tm.levels[(i - i0) + ni * (j - j0)] = rec->second.level;
+            if (i <= i1 && j <= j1)
+                sinkage_max = std::max(sinkage_max, rec->second.sinkage);
+        }
+    }
+
+    double level_min = +std::numeric_limits<double>::max();
+    double level_max = -std::numeric_limits<double>::max();
+    double level_sum = 0;
+    double grad2_max = 0;
+    for (int j = j0; j <= j1; j++) {
+        const double* z = &tm.levels[ni * (j - j0)];
+        const double* z_up = (j < j2) ? z + ni : z;
+        for (int k = 0; k <= i1 - i0; k++) {
+            level_min = std::min(level_min, z[k]);
+            level_max = std::max(level_max, z[k]);
+            level_sum += z[k];
+            double dx = (i0 + k < i2) ? z[k + 1] - z[k] : 0;
+            double dy = z_up[k] - z[k];
+            grad2_max = std::max(grad2_max, dx * dx + dy * dy);
+        }
+    }
+
+    auto& cell = tm.cells[ic];
+    cell.level_min = static_cast<float>(level_min);
+    cell.level_max = static_cast<float>(level_max);
+    cell.level_mean = static_cast<float>(level_sum / ((i1 - i0 + 1) * (j1 - j0 + 1)));
+    cell.sinkage_max = static_cast<float>(sinkage_max);
+    cell.slope = static_cast<float>(std::atan(std::sqrt(grad2_max) / m_delta));
+}
+
+// Flag the mesh tile vertices at the given grid node for the next visualization update.
+// A node on the side of a tile is shared with the adjacent tiles. In a tile at level of detail k, only nodes at
+// multiples of 2^k (and on the last row/column of the tile) are mesh vertices.
+void SCMLoaderOld::MarkMeshTileVertex(const ChVector2i& ij) {
+    int a = ij.x() + m_nx;  // node offset from lower-left grid corner
+    int b = ij.y() + m_ny;
+
+    int tx0 = (a > 0) ? (a - 1) / m_tile_size : 0;
+    int ty0 = (b > 0) ? (b - 1) / m_tile_size : 0;
+    int tx1 = std::min(a / m_tile_size, m_ntx - 1);
+    int ty1 = std::min(b / m_tile_size, m_nty - 1);
+
+    for (int ty = ty0; ty <= ty1; ty++) {
+        for (int tx = tx0; tx <= tx1; tx++) {
+            auto& tile = m_mesh_tiles[tx + m_ntx * ty];
+            tile.deformed = true;
+            if (tile.lod < 0)
+                continue;
+
+            int stride = 1 << tile.lod;
+            int nvx = (tile.cells.x() + stride - 1) / stride + 1;
+            int nvy = (tile.cells.y() + stride - 1) / stride + 1;
+            int u = ij.x() - tile.origin.x();
+            int v = ij.y() - tile.origin.y();
+            int ku = (u == tile.cells.x()) ? nvx - 1 : (u % stride == 0 ? u / stride : -1);
+            int kv = (v == tile.cells.y()) ? nvy - 1 : (v % stride == 0 ? v / stride : -1);
+            if (ku < 0 || kv < 0)
+                continue;
+
+            int iv = ku + nvx * kv;
+            if (!tile.dirty[iv]) {
+                tile.dirty[iv] = true;
+                tile.vertices.push_back(iv);
+            }
+        }
+    }
+}
+
+// Select the level of detail of all mesh tiles and update their modified vertices.
+// A tile whose level of detail changes is rebuilt; otherwise, only its modified vertices are updated.
+void SCMLoaderOld::UpdateMeshTiles() {
+    ChVector3d ref = m_frame.TransformPointParentToLocal(m_tile_lod_reference);
+    bool wireframe = m_trimesh_shape->IsWireframe();
+
+    for (auto& tile : m_mesh_tiles) {
+        // Level of detail (based on distance from tile center to reference point)
+        int lod = m_tile_lods - 1;
+        if (tile.deformed) {
+            double x = (tile.origin.x() + 0.5 * tile.cells.x()) * m_delta;
+            double y = (tile.origin.y() + 0.5 * tile.cells.y()) * m_delta;
+            double d = (ChVector3d(x, y, 0) - ref).Length();
+            lod = static_cast<int>(std::min(static_cast<double>(lod), std::floor(d / m_tile_lod_distance)));
+        }
+
+        if (lod != tile.lod) {
+            BuildMeshTile(tile, lod);
+            continue;
+        }
+
+        if (tile.vertices.empty())
+            continue;
+
+        std::sort(tile.vertices.begin(), tile.vertices.end());
+
+        auto& trimesh = *tile.shape->GetMesh();
+        int stride = 1 << tile.lod;
+        int nvx = (tile.cells.x() + stride - 1) / stride + 1;
+        int nvy = (tile.cells.y() + stride - 1) / stride + 1;
+
+        m_vis_records.clear();
+        for (int iv : tile.vertices) {
+            int u = std::min((iv % nvx) * stride, tile.cells.x());
+            int v = std::min((iv / nvx) * stride, tile.cells.y());
+            ChVector2i ij(tile.origin.x() + u, tile.origin.y() + v);  // grid location
+            const auto& nr = m_grid_map.at(ij);
+            UpdateMeshVertexCoordinates(trimesh, ij, iv, nr);
+            m_vis_records.push_back(&nr);
+            tile.dirty[iv] = false;
+        }
+
+        if (m_plot_type != SCMTerrainOld::PLOT_NONE)
+            UpdateMeshVertexColors(trimesh, tile.vertices, m_vis_records);
+
+        if (!wireframe)
+            UpdateMeshNormals(trimesh, nvx, nvy, tile.vertices);
+
+        tile.shape->SetModifiedVertices(tile.vertices);
+        tile.vertices.clear();
+    }
+}
+
+// Copy the given modified vertices into the back snapshot buffer and publish it.
+// Each buffer accumulates the vertices modified since it was last written. The first call creates all buffers as
+// copies of the complete visualization mesh. Publishing swaps the back buffer with the last published one; the
+// buffer currently read by the render thread is never written.
+void SCMLoaderOld::PublishMeshSnapshot(const std::vector<int>& modified) {
+    auto& snap = *m_vis_snapshots;
+    const auto& src = *m_trimesh_shape->GetMesh();
+
+    if (snap.published.load() == 0) {
+        for (int b = 0; b < 3; b++) {
+            snap.buffers[b] = chrono_types::make_shared<ChTriangleMeshConnected>(src);
+            snap.pending[b].clear();
+        }
+        snap.back = 0;
+        snap.front = 2;
+        snap.ready.store(1 | 4);
+        snap.published.store(1);
+        return;
+    }
+
+    int nv = (int)src.GetCoordsVertices().size();
+    for (int b = 0; b < 3; b++) {
+        auto& pending = snap.pending[b];
+        pending.insert(pending.end(), modified.begin(), modified.end());
+        if ((int)pending.size() > 2 * nv) {
+            std::sort(pending.begin(), pending.end());
+            pending.erase(std::unique(pending.begin(), pending.end()), pending.end());
+        }
+    }
+
+    // Bring the back buffer up to date
+    auto& pending = snap.pending[snap.back];
+    std::sort(pending.begin(), pending.end());
+    pending.erase(std::unique(pending.begin(), pending.end()), pending.end());
+
+    auto& dst = *snap.buffers[snap.back];
+    const auto& src_vertices = src.GetCoordsVertices();
+    const auto& src_normals = src.GetCoordsNormals();
+    const auto& src_colors = src.GetCoordsColors();
+    auto& dst_vertices = dst.GetCoordsVertices();
+    auto& dst_normals = dst.GetCoordsNormals();
+    auto& dst_colors = dst.GetCoordsColors();
+    for (int iv : pending) {
+        dst_vertices[iv] = src_vertices[iv];
+        dst_normals[iv] = src_normals[iv];
+        dst_colors[iv] = src_colors[iv];
+    }
+    pending.clear();
+
+    // Publish the back buffer and take over the previously published one
+    snap.back = snap.ready.exchange(snap.back | 4) & 3;
+    snap.published++;
+}
+
+// Record the given grid nodes as modified in all state snapshots.
+void SCMLoaderOld::MarkSnapshotNodes(const std::vector<ChVector2i>& nodes) {
+    for (auto& snap : m_snapshots)
+        snap.pending.insert(snap.pending.end(), nodes.begin(), nodes.end());
+}
+
+// Bring the oldest state snapshot up to date and make it current.
+// The oldest snapshot may still be used by readers which acquired it two steps ago; wait for these to complete. New
+// readers always acquire the current snapshot, so they do not delay the update.
+void SCMLoaderOld::PublishStateSnapshot() {
+    int current = m_snapshot_current.load();
+    int next = (current + 1) % 3;
+    auto& snap = m_snapshots[next];
+
+    while (snap.readers.load() > 0)
+        std::this_thread::yield();
+
+    std::sort(snap.pending.begin(), snap.pending.end(), CoordLess());
+    snap.pending.erase(std::unique(snap.pending.begin(), snap.pending.end()), snap.pending.end());
+    for (const auto& ij : snap.pending) {
+        auto rec = m_grid_map.find(ij);
+        if (rec == m_grid_map.end()) {  // node no longer recorded (restored checkpoint)
+            snap.nodes.erase(ij);
+            continue;
+        }
+        const auto& nr = rec->second;
+        auto& sn = snap.nodes[ij];
+        sn.level = nr.level;
+        sn.sinkage = nr.sinkage;
+        sn.sinkage_plastic = nr.sinkage_plastic;
+        sn.sinkage_elastic = nr.sinkage_elastic;
+        sn.sigma = nr.sigma;
+        sn.sigma_yield = nr.sigma_yield;
+        sn.kshear = nr.kshear;
+        sn.tau = nr.tau;
+    }
+    snap.pending.clear();
+
+    snap.epoch = m_snapshots[current].epoch + 1;
+    m_snapshot_current.store(next);
+}
+
+// Get the terrain height (relative to the SCM plane) at the specified grid node, from the given state snapshot.
+double SCMLoaderOld::GetSnapshotHeight(const StateSnapshot& snap, const ChVector2i& loc) const {
+    auto p = snap.nodes.find(loc);
+    if (p != snap.nodes.end())
+        return p->second.level;
+    return GetInitHeight(loc);
+}
+
+// Update vertex position in visualization mesh
+void SCMLoaderOld::UpdateMeshVertexCoordinates(ChTriangleMeshConnected& trimesh,
+                                               const ChVector2i ij,
+                                               int iv,
+                                               const NodeRecord& nr) {
+    std::vector<ChVector3d>& vertices = trimesh.GetCoordsVertices();
+
+    // Update visualization mesh vertex position
+    vertices[iv] = m_frame.TransformPointLocalToParent(ChVector3d(ij.x() * m_delta, ij.y() * m_delta, nr.level));
+}
+
+// Update vertex colors in visualization mesh.
+// The plotted quantity is first extracted from all node records, then mapped to colors through the colormap lookup
+// table (rebuilt only when the plot settings change).
+void SCMLoaderOld::UpdateMeshVertexColors(ChTriangleMeshConnected& trimesh,
+                                          const std::vector<int>& vertices,
+                                          const std::vector<const NodeRecord*>& records) {
+    if (m_colormap_lut.empty())
+        UpdateColormapLUT();
+
+    size_t n = vertices.size();
+    m_vis_values.resize(n);
+    float* values = m_vis_values.data();
+
+    // Extract plot values
+    double NodeRecord::*field = nullptr;
+    switch (m_plot_type) {
+        case SCMTerrainOld::PLOT_LEVEL:
+            field = &NodeRecord::level;
+            break;
+        case SCMTerrainOld::PLOT_LEVEL_INITIAL:
+            field = &NodeRecord::level_initial;
+            break;
+        case SCMTerrainOld::PLOT_SINKAGE:
+            field = &NodeRecord::sinkage;
+            break;
+        case SCMTerrainOld::PLOT_SINKAGE_ELASTIC:
+            field = &NodeRecord::sinkage_elastic;
+            break;
+        case SCMTerrainOld::PLOT_SINKAGE_PLASTIC:
+            field = &NodeRecord::sinkage_plastic;
+            break;
+        case SCMTerrainOld::PLOT_STEP_PLASTIC_FLOW:
+            field = &NodeRecord::step_plastic_flow;
+            break;
+        case SCMTerrainOld::PLOT_K_JANOSI:
+            field = &NodeRecord::kshear;
+            break;
+        case SCMTerrainOld::PLOT_PRESSURE:
+            field = &NodeRecord::sigma;
+            break;
+        case SCMTerrainOld::PLOT_PRESSURE_YIELD:
+            field = &NodeRecord::sigma_yield;
+            break;
+        case SCMTerrainOld::PLOT_SHEAR:
+            field = &NodeRecord::tau;
+            break;
+        case SCMTerrainOld::PLOT_MASSREMAINDER:
+            field = &NodeRecord::massremainder;
+            break;
+        default:
+            break;
+    }
+    if (field) {
+        for (size_t k = 0; k < n; k++)
+            values[k] = static_cast<float>(records[k]->*field);
+    } else {
+        for (size_t k = 0; k < n; k++)
+            values[k] = static_cast<float>(GetPlotValue(*records[k]));
+    }
+
+    // Map plot values to colors
+    std::vector<ChColor>& colors = trimesh.GetCoordsColors();
+    const ChColor* lut = m_colormap_lut.data();
+    int last = static_cast<int>(m_colormap_lut.size()) - 1;
+    double offset = m_colormap_lut_offset;
+    double scale = m_colormap_lut_scale;
+    for (size_t k = 0; k < n; k++) {
+        double x = (values[k] - offset) * scale;
+        int index = (x > 0) ? std::min(static_cast<int>(x), last) : 0;
+        colors[vertices[k]] = lut[index];
+    }
+}
+
+// Build the colormap lookup table for the current plot type, range, and colormap.
+// Flag plot types use one table entry per flag value (see GetPlotValue). All other plot types sample the colormap at
+// 256 uniformly spaced values over the plot range, with the range ends mapped exactly to the colormap ends.
+void SCMLoaderOld::UpdateColormapLUT() {
+    switch (m_plot_type) {
+        case SCMTerrainOld::PLOT_ISLAND_ID:
+            m_colormap_lut = {ChColor(), ChColor(0, 0, 0), ChColor(1, 0, 0)};
+            m_colormap_lut_offset = -0.5;
+            m_colormap_lut_scale = 1;
+            break;
+        case SCMTerrainOld::PLOT_IS_TOUCHED:
+            m_colormap_lut = {ChColor(0, 0, 1), ChColor(1, 0, 0)};
+            m_colormap_lut_offset = -0.5;
+            m_colormap_lut_scale = 1;
+            break;
+        default: {
+            const int n = 256;
+            m_colormap_lut.resize(n);
+            for (int k = 0; k < n; k++)
+                m_colormap_lut[k] = m_colormap->Get(k / (n - 1.0));
+            double range = m_plot_v_max - m_plot_v_min;
+            m_colormap_lut_offset = m_plot_v_min - 0.5 * range / (n - 1);
+            m_colormap_lut_scale = (range > 0) ? (n - 1) / range : 0;
+            break;
+        }
+    }
+}
+
+// Return the value of the current plot quantity at the given node.
+double SCMLoaderOld::GetPlotValue(const NodeRecord& nr) const {
+    return GetPlotValue(nr, m_plot_type);
+}
+
+// Return the value of the specified plot quantity at the given node.
+// For the flag plot types, return 1 if the node is touched (or 2 if touched and 1 if eroded for island plots).
+double SCMLoaderOld::GetPlotValue(const NodeRecord& nr, SCMTerrainOld::DataPlotType type) {
+    switch (type) {
+        case SCMTerrainOld::PLOT_LEVEL:
+            return nr.level;
+        case SCMTerrainOld::PLOT_LEVEL_INITIAL:
+            return nr.level_initial;
+        case SCMTerrainOld::PLOT_SINKAGE:
+            return nr.sinkage;
+        case SCMTerrainOld::PLOT_SINKAGE_ELASTIC:
+            return nr.sinkage_elastic;
+        case SCMTerrainOld::PLOT_SINKAGE_PLASTIC:
+            return nr.sinkage_plastic;
+        case SCMTerrainOld::PLOT_STEP_PLASTIC_FLOW:
+            return nr.step_plastic_flow;
+        case SCMTerrainOld::PLOT_K_JANOSI:
+            return nr.kshear;
+        case SCMTerrainOld::PLOT_PRESSURE:
+            return nr.sigma;
+        case SCMTerrainOld::PLOT_PRESSURE_YIELD:
+            return nr.sigma_yield;
+        case SCMTerrainOld::PLOT_SHEAR:
+            return nr.tau;
+        case SCMTerrainOld::PLOT_MASSREMAINDER:
+            return nr.massremainder;
+        case SCMTerrainOld::PLOT_ISLAND_ID:
+            return (nr.sigma > 0) ? 2 : (nr.erosion ? 1 : 0);
+        case SCMTerrainOld::PLOT_IS_TOUCHED:
+            return (nr.sigma > 0) ? 1 : 0;
+        case SCMTerrainOld::PLOT_NONE:
+            break;
+    }
+    return 0;
+}
+
+// Update normals of a rectangle of vertices of the visualization mesh.
+// Face normals are calculated once per call (instead of once for each incident vertex) in a preallocated buffer, one
+// row of mesh cells at a time: the cells above a row of vertices are the cells below the next row. Missing cells (on
+// the mesh boundary) have null face normals, so that all vertices are processed by the same branch-free loop.
+void SCMLoaderOld::UpdateMeshVertexNormals(ChTriangleMeshConnected& trimesh,
+                                           int nvx,
+                                           int nvy,
+                                           int i0,
+                                           int j0,
+                                           int ni,
+                                           int nj) {
+    const ChVector3d* vertices = trimesh.GetCoordsVertices().data();
+    ChVector3d* normals = trimesh.GetCoordsNormals().data();
+
+    // Cells incident to the vertices of a row (cell (i,j) has lower-left vertex (i,j)), from the cell to the left of
+    // the first vertex to the cell to the right of the last one. Face 0 of a cell is (v0, v0+1, v0+nvx+1) and face 1
+    // is (v0, v0+nvx+1, v0+nvx).
+    int nq = ni + 1;
+    int q_min = std::max(i0 - 1, 0);             // first existing cell
+    int q_max = std::min(i0 + ni - 1, nvx - 2);  // last existing cell
+
+    // Calculate the face normals of the given row of cells
+    auto face_normals = [&](int r, ChVector3d* fn) {
+        std::fill(fn, fn + 2 * nq, VNULL);
+        if (r < 0 || r > nvy - 2)
+            return;
+        const ChVector3d* v0 = vertices + nvx * r;
+        const ChVector3d* v1 = v0 + nvx;
+        ChVector3d* f = fn + 2 * (q_min - (i0 - 1));
+        for (int q = q_min; q <= q_max; q++, f += 2) {
+            ChVector3d e1 = v0[q + 1] - v0[q];
+            ChVector3d e2 = v1[q + 1] - v0[q];
+            ChVector3d e3 = v1[q] - v0[q];
+            ChVector3d nrm0 = Vcross(e1, e2);
+            ChVector3d nrm1 = Vcross(e2, e3);
+            // faces of a height field grid are never degenerate (edges have non-zero projections on the grid plane)
+            f[0] = nrm0 / nrm0.Length();
+            f[1] = nrm1 / nrm1.Length();
+        }
+    };
+
+    ChVector3d* fn_below = m_vis_face_normals.data();
+    ChVector3d* fn_above = fn_below + 2 * nq;
+    face_normals(j0 - 1, fn_below);
+
+    for (int j = j0; j < j0 + nj; j++) {
+        face_normals(j, fn_above);
+
+        // Average normals from adjacent faces (6 for interior vertices, fewer on the mesh boundary)
+        int below = (j > 0);        // cells in row j-1 exist
+        int above = (j < nvy - 1);  // cells in row j exist
+        ChVector3d* nrm = normals + nvx * j;
+        for (int k = 0; k < ni; k++) {
+            int i = i0 + k;
+            int left = (i > 0);
+            int right = (i < nvx - 1);
+            int count = below * (2 * left + right) + above * (left + 2 * right);
+            const ChVector3d* fl_below = fn_below + 2 * k;  // faces of the cells below, starting on the left
+            const ChVector3d* fl_above = fn_above + 2 * k;  // faces of the cells above, starting on the left
+            ChVector3d sum = fl_below[0] + fl_below[1] + fl_below[3] + fl_above[0] + fl_above[2] + fl_above[3];
+            nrm[i] = sum / (double)count;
+        }
+
+        std::swap(fn_below, fn_above);
+    }
+}
+
+// Update normals at the given vertices (sorted, unique) of a visualization mesh grid.
+// Vertices are processed in rectangles: a run of consecutive vertices on a mesh row is merged with the runs spanning
+// the same columns on the following rows, so that face normals are shared across rows.
+void SCMLoaderOld::UpdateMeshNormals(ChTriangleMeshConnected& trimesh,
+                                     int nvx,
+                                     int nvy,
+                                     const std::vector<int>& vertices) {
+    size_t nv = vertices.size();
+
+    // Length of the run of consecutive vertices on one mesh row starting at vertices[k]
+    auto run_length = [&](size_t k) {
+        int iv = vertices[k];
+        int n = 1;
+        while (k + n < nv && vertices[k + n] == iv + n && (iv + n) % nvx != 0)
+            n++;
+        return n;
+    };
+
+    size_t k = 0;
+    while (k < nv) {
+        int iv = vertices[k];
+        int n = run_length(k);
+        k += n;
+
+        // Extend the rectangle with the runs at the same columns on the next rows
+        int rows = 1;
+        while (k < nv && vertices[k] == iv + rows * nvx && run_length(k) == n) {
+            k += n;
+            rows++;
+        }
+
+        UpdateMeshVertexNormals(trimesh, nvx, nvy, iv % nvx, iv / nvx, n, rows);
+    }
+}
+
+// Get the heights of modified grid nodes.
+std::vector<SCMTerrainOld::NodeLevel> SCMLoaderOld::GetModifiedNodes(bool all_nodes) const {
+    std::vector<SCMTerrainOld::NodeLevel> nodes;
+    nodes.reserve(all_nodes ? m_grid_map.size() : m_modified_nodes.size());
+    VisitModifiedNodes([&nodes](const ChVector2i& ij, double level) { nodes.push_back(std::make_pair(ij, level)); },
+                       all_nodes);
+    return nodes;
+}
+
+// Remove duplicate entries from the list of nodes modified over the last step.
+// Nodes can be recorded both by the contact loop and by bulldozing; sorting keeps this allocation-free.
+void SCMLoaderOld::UniqueModifiedNodes() {
+    std::sort(m_modified_nodes.begin(), m_modified_nodes.end(), CoordLess());
+    m_modified_nodes.erase(std::unique(m_modified_nodes.begin(), m_modified_nodes.end()), m_modified_nodes.end());
+}
+
+// Bucket of the spatial index containing the given grid node.
+static inline ChVector2i IndexBucket(const ChVector2i& ij, int size) {
+    auto floor_div = [size](int i) { return i >= 0 ? i / size : -((-i + size - 1) / size); };
+    return ChVector2i(floor_div(ij.x()), floor_div(ij.y()));
+}
+
+// Add a new grid map node to the spatial index.
+void SCMLoaderOld::IndexNode(const ChVector2i& ij) {
+    m_node_index[IndexBucket(ij, index_bucket)].push_back(ij);
+    MarkCheckpointNode(ij);
+}
+
+// Visit all grid map nodes in the given grid index range, using the spatial index.
+// Only the index buckets overlapping the query range are visited (or all occupied buckets, if fewer).
+template <typename Visitor>
+void SCMLoaderOld::VisitIndexedNodes(const ChVector2i& min, const ChVector2i& max, Visitor visitor) const {
+    if (min.x() > max.x() || min.y() > max.y())
+        return;
+
+    auto visit = [&](const std::vector<ChVector2i>& bucket) {
+        for (const auto& ij : bucket) {
+            if (ij.x() >= min.x() && ij.x() <= max.x() && ij.y() >= min.y() && ij.y() <= max.y())
+                visitor(ij, m_grid_map.at(ij));
+        }
+    };
+
+    ChVector2i b_min = IndexBucket(min, index_bucket);
+    ChVector2i b_max = IndexBucket(max, index_bucket);
+    double num_buckets = (double)(b_max.x() - b_min.x() + 1) * (double)(b_max.y() - b_min.y() + 1);
+
+    if (num_buckets > (double)m_node_index.size()) {
+        for (const auto& b : m_node_index) {
+            if (b.first.x() >= b_min.x() && b.first.x() <= b_max.x() && b.first.y() >= b_min.y() &&
+                b.first.y() <= b_max.y())
+                visit(b.second);
+        }
+    } else {
+        for (int bj = b_min.y(); bj <= b_max.y(); bj++) {
+            for (int bi = b_min.x(); bi <= b_max.x(); bi++) {
+                auto b = m_node_index.find(ChVector2i(bi, bj));
+                if (b != m_node_index.end())
+                    visit(b->second);
+            }
+        }
+    }
+}
+
+// Get the heights of modified grid nodes in the given grid index range and accepted by the specified filter.
+// For all modified nodes, the spatial index is used.  Nodes modified over the last step are few and are filtered
+// directly.
+template <typename Filter>
+std::vector<SCMTerrainOld::NodeLevel> SCMLoaderOld::GetModifiedNodes(const ChVector2i& min,
+                                                                     const ChVector2i& max,
+                                                                     Filter filter,
+                                                                     bool all_nodes) const {
+    std::vector<SCMTerrainOld::NodeLevel> nodes;
+    if (min.x() > max.x() || min.y() > max.y())
+        return nodes;
+
+    auto in_range = [&min, &max](const ChVector2i& ij) {
+        return ij.x() >= min.x() && ij.x() <= max.x() && ij.y() >= min.y() && ij.y() <= max.y();
+    };
+
+    if (!all_nodes) {
+        for (const auto& ij : m_modified_nodes) {
+            if (in_range(ij) && filter(ij))
+                nodes.push_back(std::make_pair(ij, m_grid_map.at(ij).level));
+        }
+        return nodes;
+    }
+
+    VisitIndexedNodes(min, max, [&](const ChVector2i& ij, const NodeRecord& nr) {
+        if (filter(ij))
+            nodes.push_back(std::make_pair(ij, nr.level));
+    });
+
+    return nodes;
+}
+
+// Modify the level of grid nodes from the given list.
+// NOTE: We set only the level of the specified nodes and none of the other soil properties.
+//       As such, some plot types may be incorrect at these nodes.
+void SCMLoaderOld::SetModifiedNodes(const std::vector<SCMTerrainOld::NodeLevel>& nodes) {
+    SetNodeLevels([&nodes](auto set) {
+        for (const auto& n : nodes)
+            set(n.first, n.second);
+    });
+}
+
+// Modify the level of grid nodes provided by the given source.
+// The source is called once, with a function to be invoked with each (grid node, level) pair.
+template <typename NodeSource>
+void SCMLoaderOld::SetNodeLevels(NodeSource source) {
+    // Node records are replaced, so the cached erosion domain must be rebuilt
+    ResetErosionDomain();
+
+    bool visualization = m_trimesh_shape || m_heightfield || m_traversability;
+    std::vector<ChVector2i> locs;
+
+    source([&](const ChVector2i& ij, double level) {
+        // Modify existing entry in grid map or insert new one
+        auto rec = m_grid_map.find(ij);
+        if (rec == m_grid_map.end()) {
+            m_stats.net_volume += (level - GetInitHeight(ij)) * m_area;
+            m_grid_map.insert(std::make_pair(ij, NodeRecord(level, level, GetInitNormal(ij))));
+            IndexNode(ij);
+        } else {
+            MarkCheckpointNode(ij);
+            m_stats.net_volume += (level - rec->second.level) * m_area;
+            m_stats.plastic_volume -= rec->second.sinkage_plastic * m_area;
+            rec->second = NodeRecord(level, level, GetInitNormal(ij));
+        }
+
+        // Defer update of the visualization mesh
+        if (visualization)
+            MarkVisualizationNode(ij);
+
+        // Record modified node for the next state snapshot
+        if (m_state_snapshots)
+            locs.push_back(ij);
+    });
+
+    if (m_state_snapshots)
+        MarkSnapshotNodes(locs);
+
+    // Modifications outside the SCM step are recorded with the next keyframe
+    if (m_recorder)
+        m_recorder->force_keyframe = true;
+}
+
+// Apply a sorted batch of grid node updates, preserving the deformation history of the nodes.
+// A level change is applied as material added to or removed from the node (the initial level is shifted together with
+// the node level, so that the sinkage is unchanged). If the plastic sinkage is provided, the node is considered
+// unloaded at the given level (sinkage equal to the plastic sinkage).
+void SCMLoaderOld::ApplyNodeUpdates(const std::vector<SCMTerrainOld::NodeUpdate>& updates, int fields) {
+    for (size_t k = 1; k < updates.size(); k++) {
+        if (!CoordLess()(updates[k - 1].ij, updates[k].ij)) {
+            std::cerr << "SCM node updates not sorted or not unique at grid node (" << updates[k].ij.x() << ", "
+                      << updates[k].ij.y() << ")" << std::endl;
+            throw std::runtime_error("SCM node updates must be sorted and unique");
+        }
+    }
+
+    // Complete any deferred bulldozing job, so that its results do not overwrite the updates.
+    // Node records are preserved, so the cached erosion domain remains valid.
+    WaitBulldozing();
+
+    bool visualization = m_trimesh_shape || m_heightfield || m_traversability;
+    std::vector<ChVector2i> locs;
+    if (m_state_snapshots)
+        locs.reserve(updates.size());
+
+    for (const auto& u : updates) {
+        auto rec = m_grid_map.find(u.ij);
+        if (rec == m_grid_map.end()) {
+            double z = GetInitHeight(u.ij);
+            rec = m_grid_map.insert(std::make_pair(u.ij, NodeRecord(z, z, GetInitNormal(u.ij)))).first;
+            IndexNode(u.ij);
+        } else {
+            MarkCheckpointNode(u.ij);
+        }
+
+        auto& nr = rec->second;
+        double level_prev = nr.level;
+        double plastic_prev = nr.sinkage_plastic;
+
+        if (fields & SCMTerrainOld::UPDATE_SINKAGE_PLASTIC) {
+            nr.sinkage_plastic = u.sinkage_plastic;
+            nr.sinkage = u.sinkage_plastic;
+            nr.sinkage_elastic = 0;
+            nr.level = u.level;
+            nr.level_initial = u.level + u.sinkage_plastic / nr.normal.z();
+        } else {
+            nr.level_initial += u.level - nr.level;
+            nr.level = u.level;
+        }
+        if (fields & SCMTerrainOld::UPDATE_SIGMA_YIELD)
+            nr.sigma_yield = u.sigma_yield;
+        if (fields & SCMTerrainOld::UPDATE_KSHEAR)
+            nr.kshear = u.kshear;
+
+        // Update aggregate statistics
+        m_stats.net_volume += (nr.level - level_prev) * m_area;
+        m_stats.plastic_volume += (nr.sinkage_plastic - plastic_prev) * m_area;
+        m_stats.max_sinkage = std::max(m_stats.max_sinkage, nr.sinkage);
+
+        // Defer update of the visualization mesh
+        if (visualization)
+            MarkVisualizationNode(u.ij);
+
+        // Record modified node for the next state snapshot
+        if (m_state_snapshots)
+            locs.push_back(u.ij);
+    }
+
+    if (m_state_snapshots)
+        MarkSnapshotNodes(locs);
+
+    // Modifications outside the SCM step are recorded with the next keyframe
+    if (m_recorder)
+        m_recorder->force_keyframe = true;
+}
+
+// -----------------------------------------------------------------------------
+// Compact delta format for grid node heights
+// -----------------------------------------------------------------------------
+
+// The encoded data consists of a format version byte and the level quantization step (8 bytes, little endian),
+// followed by runs of consecutive grid nodes along a grid row, terminated by an empty run. Each run is coded as:
+//   - number of nodes in the run (unsigned)
+//   - Y grid index, relative to the Y grid index of the previous run (signed)
+//   - X grid index of the first node, relative to the end of the previous run if on the same row (signed)
+//   - quantized node levels relative to the undeformed terrain height, as differences from the previous node of the
+//     run (signed)
+// Unsigned integers are coded as base-128 varints, signed integers are zigzag-coded first.
+
+static const std::uint8_t wire_format_version = 1;
+
+static inline void PutVarint(std::vector<std::uint8_t>& buffer, std::uint64_t v) {
+    while (v >= 0x80) {
+        buffer.push_back(static_cast<std::uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    buffer.push_back(static_cast<std::uint8_t>(v));
+}
+
+static inline void PutZigzag(std::vector<std::uint8_t>& buffer, std::int64_t v) {
+    PutVarint(buffer, (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63));
+}
+
+static inline bool GetVarint(const std::uint8_t*& data, const std::uint8_t* end, std::uint64_t& v) {
+    v = 0;
+    for (int shift = 0; data < end && shift < 64; shift += 7) {
+        std::uint8_t b = *data++;
+        v |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static inline bool GetZigzag(const std::uint8_t*& data, const std::uint8_t* end, std::int64_t& v) {
+    std::uint64_t u;
+    if (!GetVarint(data, end, u))
+        return false;
+    v = static_cast<std::int64_t>(u >> 1) ^ -static_cast<std::int64_t>(u & 1);
+    return true;
+}
+
+// Encode the heights of modified grid nodes in the compact delta format.
+void SCMLoaderOld::EncodeModifiedNodes(std::vector<std::uint8_t>& buffer, double resolution, bool all_nodes) const {
+    if (!(resolution > 0)) {
+        std::cerr << "Invalid level resolution for SCM node encoding: " << resolution << std::endl;
+        throw std::runtime_error("Invalid level resolution");
+    }
+
+    // Grid nodes, row after row (the nodes modified over the last step are already sorted and unique)
+    std::vector<ChVector2i> grid_nodes;
+    if (all_nodes) {
+        grid_nodes.reserve(m_grid_map.size());
+        for (const auto& nr : m_grid_map)
+            grid_nodes.push_back(nr.first);
+        std::sort(grid_nodes.begin(), grid_nodes.end(), CoordLess());
+    }
+    const auto& locs = all_nodes ? grid_nodes : m_modified_nodes;
+
+    buffer.clear();
+    buffer.reserve(9 + 3 * locs.size());
+    buffer.push_back(wire_format_version);
+    std::uint64_t res;
+    std::memcpy(&res, &resolution, sizeof(res));
+    for (int k = 0; k < 8; k++)
+        buffer.push_back(static_cast<std::uint8_t>(res >> (8 * k)));
+
+    int prev_j = 0;  // row of previous run
+    int prev_i = 0;  // end of previous run
+    for (size_t k = 0; k < locs.size();) {
+        // Find the run of consecutive nodes starting at this node
+        size_t n = 1;
+        while (k + n < locs.size() && locs[k + n].y() == locs[k].y() && locs[k + n].x() == locs[k].x() + (int)n)
+            n++;
+
+        int i0 = locs[k].x();
+        int j = locs[k].y();
+        PutVarint(buffer, n);
+        PutZigzag(buffer, (std::int64_t)j - prev_j);
+        PutZigzag(buffer, (std::int64_t)i0 - (j == prev_j ? prev_i : 0));
+
+        std::int64_t prev_q = 0;
+        for (size_t r = 0; r < n; r++) {
+            const auto& ij = locs[k + r];
+            double dz = m_grid_map.at(ij).level - GetInitHeight(ij);
+            auto q = static_cast<std::int64_t>(std::llround(dz / resolution));
+            PutZigzag(buffer, q - prev_q);
+            prev_q = q;
+        }
+
+        prev_j = j;
+        prev_i = i0 + (int)n;
+        k += n;
+    }
+    PutVarint(buffer, 0);
+}
+
+// Decode grid node heights in the compact delta format, passing each (grid node, level) to the given visitor.
+template <typename Visitor>
+void SCMLoaderOld::DecodeModifiedNodes(const std::uint8_t* data, size_t size, Visitor visitor) const {
+    const std::uint8_t* end = data + size;
+    auto fail = [](const char* msg) {
+        std::cerr << "Invalid SCM encoded nodes: " << msg << std::endl;
+        throw std::runtime_error("Invalid SCM encoded nodes");
+    };
+
+    if (size < 9 || data[0] != wire_format_version)
+        fail("unsupported format");
+    std::uint64_t res = 0;
+    for (int k = 0; k < 8; k++)
+        res |= static_cast<std::uint64_t>(data[1 + k]) << (8 * k);
+    double resolution;
+    std::memcpy(&resolution, &res, sizeof(resolution));
+    if (!(resolution > 0) || !std::isfinite(resolution))
+        fail("invalid level resolution");
+    data += 9;
+
+    std::int64_t j = 0;  // row of current run
+    std::int64_t i = 0;  // end of current run
+    while (true) {
+        std::uint64_t n;
+        std::int64_t dj, di;
+        if (!GetVarint(data, end, n))
+            fail("truncated data");
+        if (n == 0)
+            break;
+        if (!GetZigzag(data, end, dj) || !GetZigzag(data, end, di))
+            fail("truncated data");
+        // Each node level takes at least one byte; runs must lie within a grid row
+        if (n > static_cast<std::uint64_t>(end - data))
+            fail("truncated data");
+        if (dj < -2 * m_ny || dj > 2 * m_ny || di < -2 * m_nx || di > 2 * m_nx)
+            fail("grid node out of range");
+        i = (dj == 0 ? i : 0) + di;
+        j += dj;
+        if (j < -m_ny || j > m_ny || i < -m_nx || i + static_cast<std::int64_t>(n) - 1 > m_nx)
+            fail("grid node out of range");
+
+        std::int64_t q = 0;
+        for (std::uint64_t r = 0; r < n; r++, i++) {
+            std::int64_t dq;
+            if (!GetZigzag(data, end, dq))
+                fail("truncated data");
+            q += dq;
+            ChVector2i ij((int)i, (int)j);
+            visitor(ij, GetInitHeight(ij) + q * resolution);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Raster export
+// -----------------------------------------------------------------------------
+
+// Write the values of a node quantity over the entire patch as a raw raster file.
+// The raster is processed in bands of rows. Each band is first filled with the values at the undeformed terrain (in
+// parallel), then the recorded nodes in the band are scattered through the spatial index. Samples of a band are
+// written on a separate thread while the next band is filled. For 16-bit samples, the value range is obtained in a
+// first pass over all bands.
+void SCMLoaderOld::WriteRaster(const std::string& filename,
+                               SCMTerrainOld::DataPlotType field,
+                               SCMTerrainOld::RasterFormat format) const {
+    if (field == SCMTerrainOld::PLOT_NONE) {
+        std::cerr << "Invalid field for SCM raster export" << std::endl;
+        throw std::runtime_error("Invalid field for SCM raster export");
+    }
+
+    const int nthreads = GetSystem()->GetNumThreadsChrono();
+    const int width = 2 * m_nx + 1;
+    const int height = 2 * m_ny + 1;
+    const int band_rows = std::max(1, (1 << 20) / width);  // about 1M samples per band
+    const bool level = (field == SCMTerrainOld::PLOT_LEVEL || field == SCMTerrainOld::PLOT_LEVEL_INITIAL);
+
+    // Fill the values in the band of 'rows' raster rows starting at raster row 'row'
+    std::vector<float> values;
+    auto fill = [&](int row, int rows) {
+        values.resize((size_t)width * rows);
+        int j0 = row - m_ny;
+#pragma omp parallel for num_threads(nthreads)
+        for (int v = 0; v < rows; v++) {
+            float* band_row = values.data() + (size_t)width * v;
+            for (int u = 0; u < width; u++)
+                band_row[u] = level ? static_cast<float>(GetInitHeight(ChVector2i(u - m_nx, j0 + v))) : 0.0f;
+        }
+        VisitIndexedNodes(ChVector2i(-m_nx, j0), ChVector2i(m_nx, j0 + rows - 1),
+                          [&](const ChVector2i& ij, const NodeRecord& nr) {
+                              size_t k = (size_t)(ij.x() + m_nx) + (size_t)width * (size_t)(ij.y() - j0);
+                              values[k] = static_cast<float>(GetPlotValue(nr, field));
+                          });
+    };
+
+    SCMTerrainOld::RasterHeader hdr;
+    std::memset(&hdr, 0, sizeof(hdr));
+    std::memcpy(hdr.magic, "SCMRAST", 8);
+    hdr.version = 1;
+    hdr.header_size = sizeof(SCMTerrainOld::RasterHeader);
+    hdr.width = width;
+    hdr.height = height;
+    hdr.field = field;
+    hdr.format = format;
+    hdr.x0 = -m_nx * m_delta;
+    hdr.y0 = -m_ny * m_delta;
+    hdr.delta = m_delta;
+    hdr.offset = 0;
+    hdr.scale = 1;
+
+    // Range of values (16-bit samples)
+    if (format == SCMTerrainOld::RASTER_UINT16) {
+        float vmin = std::numeric_limits<float>::max();
+        float vmax = std::numeric_limits<float>::lowest();
+        for (int row = 0; row < height; row += band_rows) {
+            fill(row, std::min(band_rows, height - row));
+            auto range = std::minmax_element(values.begin(), values.end());
+            vmin = std::min(vmin, *range.first);
+            vmax = std::max(vmax, *range.second);
+        }
+        hdr.offset = vmin;
+        hdr.scale = (vmax > vmin) ? (double(vmax) - double(vmin)) / 65535 : 1.0;
+    }
+    const size_t sample_size = (format == SCMTerrainOld::RASTER_UINT16) ? sizeof(std::uint16_t) : sizeof(float);
+
+    FILE* file = std::fopen(filename.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Error in opening SCM raster file " << filename << std::endl;
+        throw std::runtime_error("Cannot open SCM raster file");
+    }
+    bool ok = std::fwrite(&hdr, sizeof(hdr), 1, file) == 1;
+
+    // Stream bands of samples (double-buffered: a band is written while the next one is filled)
+    std::vector<std::uint8_t> samples[2];
+    std::future<bool> pending;
+    for (int row = 0, b = 0; ok && row < height; row += band_rows, b = 1 - b) {
+        int rows = std::min(band_rows, height - row);
+        fill(row, rows);
+
+        auto& out = samples[b];
+        out.resize(values.size() * sample_size);
+        if (format == SCMTerrainOld::RASTER_UINT16) {
+            auto out16 = reinterpret_cast<std::uint16_t*>(out.data());
+            double offset = hdr.offset;
+            double inv_scale = 1 / hdr.scale;
+#pragma omp parallel for num_threads(nthreads)
+            for (int k = 0; k < (int)values.size(); k++)
+                out16[k] = static_cast<std::uint16_t>(std::min(65535.0, std::round((values[k] - offset) * inv_scale)));
+        } else {
+            std::memcpy(out.data(), values.data(), out.size());
+        }
+
+        if (pending.valid())
+            ok = pending.get();
+        pending = std::async(std::launch::async,
+                             [file, &out]() { return std::fwrite(out.data(), 1, out.size(), file) == out.size(); });
+    }
+    if (pending.valid() && !pending.get())
+        ok = false;
+
+    if (std::fclose(file) != 0)
+        ok = false;
+    if (!ok) {
+        std::cerr << "Error in writing SCM raster file " << filename << std::endl;
+        throw std::runtime_error("Cannot write SCM raster file");
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Mesh export
+// -----------------------------------------------------------------------------
+
+static const size_t mesh_chunk_items = 8192;  // number of vertices or faces formatted per chunk
+
+// Format 'count' items in chunks and write them to the given file.
+// The formatter writes items [first, last) to the provided buffer and returns the number of bytes written, which
+// must not exceed 'item_size' bytes per item. Chunks are formatted in parallel, one batch of 'nthreads' chunks at a
+// time, into preallocated buffers. A batch is written on a separate thread while the next one is formatted.
+template <typename Formatter>
+static bool WriteMeshChunks(FILE* file, size_t count, size_t item_size, int nthreads, Formatter format) {
+    if (count == 0)
+        return true;
+
+    const int num_chunks = (int)((count + mesh_chunk_items - 1) / mesh_chunk_items);
+    const int batch = std::max(1, std::min(nthreads, num_chunks));
+    const size_t stride = std::min(count, mesh_chunk_items) * item_size;
+
+    std::vector<char> buffers[2];
+    std::vector<size_t> sizes[2];
+    for (int b = 0; b < 2; b++) {
+        buffers[b].resize(batch * stride);
+        sizes[b].resize(batch);
+    }
+
+    bool ok = true;
+    std::future<bool> pending;
+    for (int c0 = 0, b = 0; ok && c0 < num_chunks; c0 += batch, b = 1 - b) {
+        int n = std::min(batch, num_chunks - c0);
+        char* out = buffers[b].data();
+        auto& len = sizes[b];
+#pragma omp parallel for num_threads(nthreads)
+        for (int c = 0; c < n; c++) {
+            size_t first = (size_t)(c0 + c) * mesh_chunk_items;
+            size_t last = std::min(count, first + mesh_chunk_items);
+            len[c] = format(first, last, out + c * stride);
+        }
+
+        if (pending.valid())
+            ok = pending.get();
+        pending = std::async(std::launch::async, [file, out, stride, n, &len]() {
+            for (int c = 0; c < n; c++) {
+                if (std::fwrite(out + c * stride, 1, len[c], file) != len[c])
+                    return false;
+            }
+            return true;
+        });
+    }
+    if (pending.valid() && !pending.get())
+        ok = false;
+
+    return ok;
+}
+
+// Invoke fn(m, i) for the items [first, last) of a sequence of meshes, with m the mesh index and i the item index
+// within mesh m. 'offsets' contains the index of the first item of each mesh, followed by the total number of items.
+template <typename Function>
+static void ForEachMeshItem(const std::vector<size_t>& offsets, size_t first, size_t last, Function fn) {
+    size_t m = std::upper_bound(offsets.begin(), offsets.end(), first) - offsets.begin() - 1;
+    for (size_t k = first; k < last; k++) {
+        while (k >= offsets[m + 1])
+            m++;
+        fn(m, k - offsets[m]);
+    }
+}
+
+static inline char* PutUint32LE(char* p, std::uint32_t v) {
+    p[0] = (char)(v & 0xff);
+    p[1] = (char)((v >> 8) & 0xff);
+    p[2] = (char)((v >> 16) & 0xff);
+    p[3] = (char)((v >> 24) & 0xff);
+    return p + 4;
+}
+
+static inline char* PutFloatLE(char* p, double v) {
+    float f = static_cast<float>(v);
+    std::uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return PutUint32LE(p, u);
+}
+
+// Save the visualization mesh (all tiles, if tiled) to a file in the specified format.
+// Vertices and faces are read directly from the mesh assets of all tiles (no mesh copies), with the vertex indices of
+// each tile offset by the number of vertices in preceding tiles. Binary formats are written in little-endian order.
+void SCMLoaderOld::WriteMesh(const std::string& filename, SCMTerrainOld::MeshFormat format) const {
+    std::vector<ChTriangleMeshConnected*> meshes;
+    if (m_mesh_tiles.empty()) {
+        meshes.push_back(m_trimesh_shape->GetMesh().get());
+    } else {
+        for (const auto& tile : m_mesh_tiles)
+            meshes.push_back(tile.shape->GetMesh().get());
+    }
+
+    // Offsets of the vertices, normals, and faces of each mesh; check for per-vertex normals and colors
+    std::vector<size_t> vertex_offsets(1, 0);
+    std::vector<size_t> normal_offsets(1, 0);
+    std::vector<size_t> face_offsets(1, 0);
+    bool normals = true;
+    bool colors = true;
+    for (auto mesh : meshes) {
+        vertex_offsets.push_back(vertex_offsets.back() + mesh->GetCoordsVertices().size());
+        normal_offsets.push_back(normal_offsets.back() + mesh->GetCoordsNormals().size());
+        face_offsets.push_back(face_offsets.back() + mesh->GetIndicesVertexes().size());
+        normals = normals && mesh->GetIndicesNormals().size() == mesh->GetIndicesVertexes().size();
+        colors = colors && mesh->GetCoordsColors().size() == mesh->GetCoordsVertices().size();
+    }
+    const size_t num_vertices = vertex_offsets.back();
+    const size_t num_normals = normals ? normal_offsets.back() : 0;
+    const size_t num_faces = face_offsets.back();
+
+    const int nthreads = GetSystem()->GetNumThreadsChrono();
+
+    FILE* file = std::fopen(filename.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Error in opening SCM mesh file " << filename << std::endl;
+        throw std::runtime_error("Cannot open SCM mesh file");
+    }
+    bool ok = true;
+
+    switch (format) {
+        case SCMTerrainOld::MESH_OBJ: {
+            // Maximum line lengths ("%.8g" values take at most 15 characters, indices at most 20)
+            const size_t vertex_line = 64;
+            const size_t face_line = 80;
+
+            ok = std::fprintf(file, "# SCM terrain mesh\n") > 0;
+            ok = ok && WriteMeshChunks(file, num_vertices, vertex_line, nthreads,
+                                       [&](size_t first, size_t last, char* out) {
+                                           char* p = out;
+                                           ForEachMeshItem(vertex_offsets, first, last, [&](size_t m, size_t i) {
+                                               const auto& v = meshes[m]->GetCoordsVertices()[i];
+                                               p += std::snprintf(p, vertex_line, "v %.8g %.8g %.8g\n",  //
+                                                                  v.x(), v.y(), v.z());
+                                           });
+                                           return (size_t)(p - out);
+                                       });
+            ok = ok && WriteMeshChunks(file, num_normals, vertex_line, nthreads,
+                                       [&](size_t first, size_t last, char* out) {
+                                           char* p = out;
+                                           ForEachMeshItem(normal_offsets, first, last, [&](size_t m, size_t i) {
+                                               const auto& n = meshes[m]->GetCoordsNormals()[i];
+                                               p += std::snprintf(p, vertex_line, "vn %.8g %.8g %.8g\n",  //
+                                                                  n.x(), n.y(), n.z());
+                                           });
+                                           return (size_t)(p - out);
+                                       });
+            ok = ok && WriteMeshChunks(file, num_faces, face_line, nthreads, [&](size_t first, size_t last, char* out) {
+                char* p = out;
+                ForEachMeshItem(face_offsets, first, last, [&](size_t m, size_t i) {
+                    // OBJ indices are 1-based
+                    const auto& f = meshes[m]->GetIndicesVertexes()[i];
+                    long long v0 = (long long)vertex_offsets[m] + 1;
+                    if (normals) {
+                        const auto& fn = meshes[m]->GetIndicesNormals()[i];
+                        long long n0 = (long long)normal_offsets[m] + 1;
+                        p += std::snprintf(p, face_line, "f %lld//%lld %lld//%lld %lld//%lld\n",  //
+                                           v0 + f[0], n0 + fn[0], v0 + f[1], n0 + fn[1], v0 + f[2], n0 + fn[2]);
+                    } else {
+                        p += std::snprintf(p, face_line, "f %lld %lld %lld\n", v0 + f[0], v0 + f[1], v0 + f[2]);
+                    }
+                });
+                return (size_t)(p - out);
+            });
+            break;
+        }
+        case SCMTerrainOld::MESH_PLY: {
+            // Vertex records: x, y, z (float32) and optional red, green, blue (uint8)
+            // Face records: vertex count (uint8) and 3 vertex indices (int32)
+            const size_t vertex_size = colors ? 15 : 12;
+            const size_t face_size = 13;
+
+            ok = std::fprintf(file,
+                              "ply\nformat binary_little_endian 1.0\ncomment SCM terrain mesh\n"
+                              "element vertex %zu\nproperty float x\nproperty float y\nproperty float z\n",
+                              num_vertices) > 0;
+            if (ok && colors)
+                ok = std::fprintf(file, "property uchar red\nproperty uchar green\nproperty uchar blue\n") > 0;
+            ok = ok && std::fprintf(file, "element face %zu\nproperty list uchar int vertex_indices\nend_header\n",
+                                    num_faces) > 0;
+
+            ok = ok && WriteMeshChunks(file, num_vertices, vertex_size, nthreads,
+                                       [&](size_t first, size_t last, char* out) {
+                                           char* p = out;
+                                           ForEachMeshItem(vertex_offsets, first, last, [&](size_t m, size_t i) {
+                                               const auto& v = meshes[m]->GetCoordsVertices()[i];
+                                               p = PutFloatLE(p, v.x());
+                                               p = PutFloatLE(p, v.y());
+                                               p = PutFloatLE(p, v.z());
+                                               if (colors) {
+                                                   const auto& c = meshes[m]->GetCoordsColors()[i];
+                                                   *p++ = (char)ChClamp((int)std::lround(c.R * 255), 0, 255);
+                                                   *p++ = (char)ChClamp((int)std::lround(c.G * 255), 0, 255);
+                                                   *p++ = (char)ChClamp((int)std::lround(c.B * 255), 0, 255);
+                                               }
+                                           });
+                                           return (size_t)(p - out);
+                                       });
+            ok = ok && WriteMeshChunks(file, num_faces, face_size, nthreads, [&](size_t first, size_t last, char* out) {
+                char* p = out;
+                ForEachMeshItem(face_offsets, first, last, [&](size_t m, size_t i) {
+                    const auto& f = meshes[m]->GetIndicesVertexes()[i];
+                    std::uint32_t v0 = (std::uint32_t)vertex_offsets[m];
+                    *p++ = 3;
+                    p = PutUint32LE(p, v0 + f[0]);
+                    p = PutUint32LE(p, v0 + f[1]);
+                    p = PutUint32LE(p, v0 + f[2]);
+                });
+                return (size_t)(p - out);
+            });
+            break;
+        }
+        case SCMTerrainOld::MESH_STL: {
+            // 80-byte header, number of faces (uint32), then per face: normal and 3 vertices (float32), attribute
+            // byte count (uint16)
+            const size_t face_size = 50;
+
+            char header[84] = "SCM terrain mesh";
+            PutUint32LE(header + 80, (std::uint32_t)num_faces);
+            ok = std::fwrite(header, sizeof(header), 1, file) == 1;
+
+            ok = ok && WriteMeshChunks(file, num_faces, face_size, nthreads, [&](size_t first, size_t last, char* out) {
+                char* p = out;
+                ForEachMeshItem(face_offsets, first, last, [&](size_t m, size_t i) {
+                    const auto& vertices = meshes[m]->GetCoordsVertices();
+                    const auto& f = meshes[m]->GetIndicesVertexes()[i];
+                    const auto& v0 = vertices[f[0]];
+                    const auto& v1 = vertices[f[1]];
+                    const auto& v2 = vertices[f[2]];
+                    ChVector3d n = Vcross(v1 - v0, v2 - v0);
+                    double len = n.Length();
+                    if (len > 0)
+                        n /= len;
+                    for (const auto& v : {n, v0, v1, v2}) {
+                        p = PutFloatLE(p, v.x());
+                        p = PutFloatLE(p, v.y());
+                        p = PutFloatLE(p, v.z());
+                    }
+                    *p++ = 0;
+                    *p++ = 0;
+                });
+                return (size_t)(p - out);
+            });
+            break;
+        }
+    }
+
+    if (std::fclose(file) != 0)
+        ok = false;
+    if (!ok) {
+        std::cerr << "Error in writing SCM mesh file " << filename << std::endl;
+        throw std::runtime_error("Cannot write SCM mesh file");
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Checkpoint and restore
+// -----------------------------------------------------------------------------
+
+// Read-only view of a checkpoint file, memory mapped where supported.
+// The header is validated on opening; node records and grid locations are copied out of the mapped data on access.
+class SCMLoaderOld::CheckpointFile {
+  public:
+    CheckpointFile(const std::string& filename) : m_filename(filename) {
+        bool opened = false;
+#ifndef _WIN32
+        int fd = open(filename.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd >= 0 && fstat(fd, &st) == 0) {
+            size_t size = static_cast<size_t>(st.st_size);
+            void* addr = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+            if (addr != MAP_FAILED) {
+                madvise(addr, size, MADV_SEQUENTIAL);
+                m_map.data = static_cast<const char*>(addr);
+                m_map.size = size;
+                opened = true;
+            }
+        }
+        if (fd >= 0)
+            close(fd);
+#else
+        if (FILE* fp = std::fopen(filename.c_str(), "rb")) {
+            std::fseek(fp, 0, SEEK_END);
+            m_map.buffer.resize(static_cast<size_t>(std::ftell(fp)));
+            std::fseek(fp, 0, SEEK_SET);
+            opened = std::fread(m_map.buffer.data(), 1, m_map.buffer.size(), fp) == m_map.buffer.size();
+            std::fclose(fp);
+            m_map.data = m_map.buffer.data();
+            m_map.size = m_map.buffer.size();
+        }
+#endif
+        if (!opened) {
+            std::cerr << "Error in reading SCM checkpoint file " << filename << std::endl;
+            throw std::runtime_error("Cannot read SCM checkpoint file");
+        }
+
+        // Validate header and file size
+        if (m_map.size < sizeof(m_hdr)) {
+            std::cerr << "Invalid SCM checkpoint file " << filename << std::endl;
+            throw std::runtime_error("Invalid SCM checkpoint file");
+        }
+        std::memcpy(&m_hdr, m_map.data, sizeof(m_hdr));
+        if (std::memcmp(m_hdr.magic, "SCMCKPT", 8) != 0 || m_hdr.version != CheckpointHeader::current_version ||
+            m_hdr.header_size != sizeof(CheckpointHeader)) {
+            std::cerr << "Invalid SCM checkpoint file " << filename << " (unsupported format or version)" << std::endl;
+            throw std::runtime_error("Invalid SCM checkpoint file");
+        }
+        std::uint64_t num_locations = 0;
+        for (int k = 0; k < 5; k++)
+            num_locations += m_hdr.num_locations[k];
+        std::uint64_t expected_size =
+            m_hdr.header_size + m_hdr.num_nodes * sizeof(CheckpointNode) + num_locations * 2 * sizeof(std::int32_t);
+        if (m_map.size != expected_size) {
+            std::cerr << "Invalid SCM checkpoint file " << filename << " (inconsistent size)" << std::endl;
+            throw std::runtime_error("Invalid SCM checkpoint file");
+        }
+    }
+
+    const std::string& GetFilename() const { return m_filename; }
+    const CheckpointHeader& GetHeader() const { return m_hdr; }
+
+    // Get the k-th node record.
+    CheckpointNode GetNode(std::uint64_t k) const {
+        CheckpointNode cn;
+        std::memcpy(&cn, m_map.data + m_hdr.header_size + k * sizeof(CheckpointNode), sizeof(cn));
+        return cn;
+    }
+
+    // Get the grid locations in the specified list.
+    std::vector<ChVector2i> GetLocations(int list) const {
+        const char* data = m_map.data + m_hdr.header_size + m_hdr.num_nodes * sizeof(CheckpointNode);
+        for (int k = 0; k < list; k++)
+            data += m_hdr.num_locations[k] * 2 * sizeof(std::int32_t);
+        std::vector<ChVector2i> locs(m_hdr.num_locations[list]);
+        for (auto& ij : locs) {
+            std::int32_t loc[2];
+            std::memcpy(loc, data, sizeof(loc));
+            ij = ChVector2i(loc[0], loc[1]);
+            data += sizeof(loc);
+        }
+        return locs;
+    }
+
+  private:
+    // File contents, released by the destructor (also when the CheckpointFile constructor throws)
+    struct Mapping {
+        Mapping() = default;
+        Mapping(const Mapping&) = delete;
+        Mapping& operator=(const Mapping&) = delete;
+#ifndef _WIN32
+        ~Mapping() {
+            if (data)
+                munmap(const_cast<char*>(data), size);
+        }
+#else
+        std::vector<char> buffer;
+#endif
+        const char* data = nullptr;
+        size_t size = 0;
+    };
+
+    std::string m_filename;
+    Mapping m_map;
+    CheckpointHeader m_hdr;
+};
+
+SCMLoaderOld::CheckpointNode SCMLoaderOld::PackCheckpointNode(const ChVector2i& ij, const NodeRecord& nr) {
+    CheckpointNode cn;
+    cn.i = ij.x();
+    cn.j = ij.y();
+    cn.level_initial = nr.level_initial;
+    cn.level = nr.level;
+    cn.hit_level = nr.hit_level;
+    cn.normal[0] = nr.normal.x();
+    cn.normal[1] = nr.normal.y();
+    cn.normal[2] = nr.normal.z();
+    cn.sinkage = nr.sinkage;
+    cn.sinkage_plastic = nr.sinkage_plastic;
+    cn.sinkage_elastic = nr.sinkage_elastic;
+    cn.sigma = nr.sigma;
+    cn.sigma_yield = nr.sigma_yield;
+    cn.kshear = nr.kshear;
+    cn.tau = nr.tau;
+    cn.massremainder = nr.massremainder;
+    cn.step_plastic_flow = nr.step_plastic_flow;
+    cn.erosion = nr.erosion;
+    cn.erosion_hops = nr.erosion_hops;
+    return cn;
+}
+
+void SCMLoaderOld::UnpackCheckpointNode(const CheckpointNode& cn, NodeRecord& nr) {
+    nr.level_initial = cn.level_initial;
+    nr.level = cn.level;
+    nr.hit_level = cn.hit_level;
+    nr.normal = ChVector3d(cn.normal[0], cn.normal[1], cn.normal[2]);
+    nr.sinkage = cn.sinkage;
+    nr.sinkage_plastic = cn.sinkage_plastic;
+    nr.sinkage_elastic = cn.sinkage_elastic;
+    nr.sigma = cn.sigma;
+    nr.sigma_yield = cn.sigma_yield;
+    nr.kshear = cn.kshear;
+    nr.tau = cn.tau;
+    nr.massremainder = cn.massremainder;
+    nr.step_plastic_flow = cn.step_plastic_flow;
+    nr.erosion = cn.erosion != 0;
+    nr.erosion_hops = cn.erosion_hops;
+}
+
+// Fill the header of a checkpoint of the current state.
+// The location lists are: modified nodes, nodes modified by the bulldozing job, erosion domain, erosion boundary, and
+// touched nodes.
+void SCMLoaderOld::FillCheckpointHeader(CheckpointHeader& hdr, const std::vector<ChVector2i>* lists[5]) const {
+    const auto& job = m_bulldozing_job;
+    std::memset(&hdr, 0, sizeof(hdr));
+    std::memcpy(hdr.magic, "SCMCKPT", 8);
+    hdr.version = CheckpointHeader::current_version;
+    hdr.header_size = sizeof(CheckpointHeader);
+    hdr.type = static_cast<std::int32_t>(m_type);
+    hdr.nx = m_nx;
+    hdr.ny = m_ny;
+    hdr.bulldozing = m_bulldozing;
+    hdr.delta = m_delta;
+    hdr.soil[0] = m_Bekker_Kphi;
+    hdr.soil[1] = m_Bekker_Kc;
+    hdr.soil[2] = m_Bekker_n;
+    hdr.soil[3] = m_Mohr_cohesion;
+    hdr.soil[4] = m_Mohr_mu;
+    hdr.soil[5] = m_Janosi_shear;
+    hdr.soil[6] = m_elastic_K;
+    hdr.soil[7] = m_damping_R;
+    hdr.flow_factor = m_flow_factor;
+    hdr.erosion_slope = m_erosion_slope;
+    hdr.erosion_iterations = m_erosion_iterations;
+    hdr.erosion_propagations = m_erosion_propagations;
+    hdr.bulldozing_interval = m_bulldozing_interval;
+    hdr.bulldozing_counter = m_bulldozing_counter;
+    hdr.job_pending = job.pending;
+    hdr.job_num_erosion_nodes = job.num_erosion_nodes;
+    hdr.job_displaced = job.displaced;
+    hdr.job_deposited = job.deposited;
+    hdr.stats[0] = m_stats.plastic_volume;
+    hdr.stats[1] = m_stats.displaced_volume;
+    hdr.stats[2] = m_stats.deposited_volume;
+    hdr.stats[3] = m_stats.net_volume;
+    hdr.stats[4] = m_stats.max_sinkage;
+    hdr.stats_num_touched_nodes = m_stats.num_touched_nodes;
+    for (int k = 0; k < 5; k++)
+        hdr.num_locations[k] = lists[k]->size();
+}
+
+// Write a checkpoint file with the given header, node records, and location lists, sequentially in large blocks.
+// The node source fills a block of node records and returns false once all records were provided.
+template <typename NodeSource>
+void SCMLoaderOld::WriteCheckpointFile(const std::string& filename,
+                                      const CheckpointHeader& hdr,
+                                      NodeSource nodes,
+                                      const std::vector<ChVector2i>* const lists[5]) {
+    FILE* file = std::fopen(filename.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Error in opening SCM checkpoint file " << filename << std::endl;
+        throw std::runtime_error("Cannot open SCM checkpoint file");
+    }
+
+    bool ok = std::fwrite(&hdr, sizeof(hdr), 1, file) == 1;
+
+    // Node records
+    std::vector<CheckpointNode> block;
+    block.reserve(1 << 16);
+    bool more = true;
+    while (ok && more) {
+        block.clear();
+        more = nodes(block);
+        ok = std::fwrite(block.data(), sizeof(CheckpointNode), block.size(), file) == block.size();
+    }
+
+    // Lists of grid locations (pairs of grid indices)
+    std::vector<std::int32_t> locs;
+    for (int k = 0; ok && k < 5; k++) {
+        locs.clear();
+        locs.reserve(2 * lists[k]->size());
+        for (const auto& ij : *lists[k]) {
+            locs.push_back(ij.x());
+            locs.push_back(ij.y());
+        }
+        ok = std::fwrite(locs.data(), sizeof(std::int32_t), locs.size(), file) == locs.size();
+    }
+
+    if (std::fclose(file) != 0)
+        ok = false;
+    if (!ok) {
+        std::cerr << "Error in writing SCM checkpoint file " << filename << std::endl;
+        throw std::runtime_error("Cannot write SCM checkpoint file");
+    }
+}
+
+// Write a binary checkpoint of the complete SCM state and start a new checkpoint chain.
+// A deferred bulldozing job is first completed (but not collected), so that the node records are up to date.
+void SCMLoaderOld::WriteCheckpoint(const std::string& filename) {
+    WaitBulldozing();
+
+    std::vector<ChVector2i> domain(m_erosion_domain.begin(), m_erosion_domain.end());
+    std::vector<ChVector2i> boundary(m_erosion_boundary.begin(), m_erosion_boundary.end());
+    std::vector<ChVector2i> touched(m_erosion_touched.begin(), m_erosion_touched.end());
+    const std::vector<ChVector2i>* lists[5] = {&m_modified_nodes, &m_bulldozing_job.modified, &domain, &boundary,
+                                               &touched};
+
+    CheckpointHeader hdr;
+    FillCheckpointHeader(hdr, lists);
+    hdr.incremental = 0;
+    hdr.sequence = 0;
+    hdr.chain = (static_cast<std::uint64_t>(std::random_device()()) << 32) ^
+                static_cast<std::uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+    hdr.num_nodes = m_grid_map.size();
+
+    auto it = m_grid_map.begin();
+    auto nodes = [&](std::vector<CheckpointNode>& block) {
+        for (; it != m_grid_map.end() && block.size() < block.capacity(); ++it)
+            block.push_back(PackCheckpointNode(it->first, it->second));
+        return it != m_grid_map.end();
+    };
+    WriteCheckpointFile(filename, hdr, nodes, lists);
+
+    ResetCheckpointTracking(hdr.chain, hdr.sequence);
+}
+
+// Write an incremental checkpoint, with the node records in all tiles modified since the previous checkpoint.
+// Tiles are the buckets of the spatial node index, so that their nodes are directly available.
+void SCMLoaderOld::WriteCheckpointDelta(const std::string& filename) {
+    if (m_ckpt_dirty.empty()) {
+        std::cerr << "Error in writing SCM checkpoint " << filename << ": no checkpoint chain" << std::endl;
+        throw std::runtime_error("Incremental SCM checkpoint requires a previous checkpoint");
+    }
+
+    WaitBulldozing();
+
+    std::vector<ChVector2i> tiles = m_ckpt_tiles;
+    tiles.insert(tiles.end(), m_ckpt_outside.begin(), m_ckpt_outside.end());
+    std::sort(tiles.begin(), tiles.end(), CoordLess());
+
+    std::vector<ChVector2i> domain(m_erosion_domain.begin(), m_erosion_domain.end());
+    std::vector<ChVector2i> boundary(m_erosion_boundary.begin(), m_erosion_boundary.end());
+    std::vector<ChVector2i> touched(m_erosion_touched.begin(), m_erosion_touched.end());
+    const std::vector<ChVector2i>* lists[5] = {&m_modified_nodes, &m_bulldozing_job.modified, &domain, &boundary,
+                                               &touched};
+
+    CheckpointHeader hdr;
+    FillCheckpointHeader(hdr, lists);
+    hdr.incremental = 1;
+    hdr.sequence = m_ckpt_sequence + 1;
+    hdr.chain = m_ckpt_chain;
+    hdr.num_nodes = 0;
+    for (const auto& t : tiles) {
+        auto b = m_node_index.find(t);
+        if (b != m_node_index.end())
+            hdr.num_nodes += b->second.size();
+    }
+
+    size_t it = 0;  // current tile
+    size_t in = 0;  // current node in tile
+    auto nodes = [&](std::vector<CheckpointNode>& block) {
+        for (; it < tiles.size(); it++, in = 0) {
+            auto b = m_node_index.find(tiles[it]);
+            if (b == m_node_index.end())
+                continue;
+            for (; in < b->second.size(); in++) {
+                if (block.size() == block.capacity())
+                    return true;
+                const auto& ij = b->second[in];
+                block.push_back(PackCheckpointNode(ij, m_grid_map.at(ij)));
+            }
+        }
+        return false;
+    };
+    WriteCheckpointFile(filename, hdr, nodes, lists);
+
+    ResetCheckpointTracking(hdr.chain, hdr.sequence);
+}
+
+// Open the given checkpoint chain and check its consistency.
+// A chain consists of a full checkpoint followed by deltas of the same chain, with consecutive sequence numbers.
+std::vector<std::unique_ptr<SCMLoaderOld::CheckpointFile>> SCMLoaderOld::OpenCheckpointChain(
+    const std::vector<std::string>& filenames) {
+    std::vector<std::unique_ptr<CheckpointFile>> files;
+    for (const auto& filename : filenames)
+        files.push_back(chrono_types::make_unique<CheckpointFile>(filename));
+
+    if (files.empty()) {
+        std::cerr << "Empty SCM checkpoint chain" << std::endl;
+        throw std::runtime_error("Empty SCM checkpoint chain");
+    }
+    const auto& base = files[0]->GetHeader();
+    if (base.incremental) {
+        std::cerr << "SCM checkpoint " << files[0]->GetFilename() << " is not a full checkpoint" << std::endl;
+        throw std::runtime_error("SCM checkpoint chain must start with a full checkpoint");
+    }
+    for (size_t k = 1; k < files.size(); k++) {
+        const auto& hdr = files[k]->GetHeader();
+        if (!hdr.incremental || hdr.chain != base.chain || hdr.sequence != base.sequence + k) {
+            std::cerr << "SCM checkpoint " << files[k]->GetFilename() << " does not extend the checkpoint chain"
+                      << std::endl;
+            throw std::runtime_error("Inconsistent SCM checkpoint chain");
+        }
+    }
+
+    return files;
+}
+
+// Restore the SCM state from a checkpoint chain.
+// Visualization outputs are first brought to the undeformed terrain at all currently recorded grid nodes, then the grid
+// map and spatial index are rebuilt from the checkpoint node records, newest file first (a node record is restored only
+// from the last file including it). Restored nodes are flagged for the next visualization update. State snapshots drop
+// the nodes which are no longer recorded at their next update.
+void SCMLoaderOld::ReadCheckpoint(const std::vector<std::string>& filenames) {
+    auto files = OpenCheckpointChain(filenames);
+    const auto& last = *files.back();
+    const auto& hdr = last.GetHeader();
+    if (hdr.type != static_cast<std::int32_t>(m_type) || hdr.nx != m_nx || hdr.ny != m_ny || hdr.delta != m_delta) {
+        std::cerr << "SCM checkpoint file " << last.GetFilename() << " does not match the terrain patch" << std::endl;
+        throw std::runtime_error("SCM checkpoint does not match the terrain patch");
+    }
+
+    // Complete any deferred bulldozing job (its results are overwritten below)
+    WaitBulldozing();
+
+    // Reset all current grid nodes
+    std::vector<ChVector2i> changed;
+    ClearGridMap(changed);
+    size_t num_reset = changed.size();
+
+    // Rebuild grid map and spatial index from the checkpoint node records
+    m_grid_map.reserve(files[0]->GetHeader().num_nodes);
+    for (auto f = files.rbegin(); f != files.rend(); ++f) {
+        for (std::uint64_t k = 0; k < (*f)->GetHeader().num_nodes; k++) {
+            CheckpointNode cn = (*f)->GetNode(k);
+            ChVector2i ij(cn.i, cn.j);
+            auto rec = m_grid_map.insert(std::make_pair(ij, NodeRecord()));
+            if (!rec.second)
+                continue;
+            UnpackCheckpointNode(cn, rec.first->second);
+            IndexNode(ij);
+            changed.push_back(ij);
+        }
+    }
+
+    // Restore lists of grid locations
+    m_modified_nodes = last.GetLocations(0);
+    auto domain = last.GetLocations(2);
+    auto boundary = last.GetLocations(3);
+    auto touched = last.GetLocations(4);
+    m_erosion_domain = NodeSet(domain.begin(), domain.end());
+    m_erosion_boundary = NodeSet(boundary.begin(), boundary.end());
+    m_erosion_touched = NodeSet(touched.begin(), touched.end());
+
+    auto& job = m_bulldozing_job;
+    job.nodes.clear();
+    job.modified = last.GetLocations(1);
+    job.pending = hdr.job_pending != 0;
+    job.num_erosion_nodes = hdr.job_num_erosion_nodes;
+    job.displaced = hdr.job_displaced;
+    job.deposited = hdr.job_deposited;
+
+    // Restore parameters and statistics
+    m_Bekker_Kphi = hdr.soil[0];
+    m_Bekker_Kc = hdr.soil[1];
+    m_Bekker_n = hdr.soil[2];
+    m_Mohr_cohesion = hdr.soil[3];
+    m_Mohr_mu = hdr.soil[4];
+    m_Janosi_shear = hdr.soil[5];
+    m_elastic_K = hdr.soil[6];
+    m_damping_R = hdr.soil[7];
+    m_bulldozing = hdr.bulldozing != 0;
+    m_flow_factor = hdr.flow_factor;
+    m_erosion_slope = hdr.erosion_slope;
+    m_erosion_iterations = hdr.erosion_iterations;
+    m_erosion_propagations = hdr.erosion_propagations;
+    m_bulldozing_interval = hdr.bulldozing_interval;
+    m_bulldozing_counter = hdr.bulldozing_counter;
+    m_stats.plastic_volume = hdr.stats[0];
+    m_stats.displaced_volume = hdr.stats[1];
+    m_stats.deposited_volume = hdr.stats[2];
+    m_stats.net_volume = hdr.stats[3];
+    m_stats.max_sinkage = hdr.stats[4];
+    m_stats.num_touched_nodes = static_cast<int>(hdr.stats_num_touched_nodes);
+
+    // Flag all restored nodes for the next visualization update and all changed nodes for the next state snapshot
+    if (m_trimesh_shape || m_heightfield || m_traversability) {
+        for (size_t k = num_reset; k < changed.size(); k++)
+            MarkVisualizationNode(changed[k]);
+    }
+    if (m_state_snapshots) {
+        MarkSnapshotNodes(changed);
+        PublishStateSnapshot();
+    }
+
+    // Further deltas extend the restored chain
+    ResetCheckpointTracking(hdr.chain, hdr.sequence);
+
+    // The restored state is not a step of the recorded terrain evolution
+    if (m_recorder)
+        m_recorder->force_keyframe = true;
+}
+
+// Merge a checkpoint chain into a single full checkpoint.
+// Node records are taken from the newest file including them; the bulldozing state, statistics, and parameters are
+// those of the last file. The result keeps the chain identifier and the sequence number of the last file.
+void SCMLoaderOld::CompactCheckpoints(const std::vector<std::string>& filenames, const std::string& filename) {
+    auto files = OpenCheckpointChain(filenames);
+    const auto& last = *files.back();
+
+    NodeSet merged;
+    std::vector<std::pair<const CheckpointFile*, std::uint64_t>> records;  // file and index of each merged record
+    merged.reserve(files[0]->GetHeader().num_nodes);
+    records.reserve(files[0]->GetHeader().num_nodes);
+    for (auto f = files.rbegin(); f != files.rend(); ++f) {
+        for (std::uint64_t k = 0; k < (*f)->GetHeader().num_nodes; k++) {
+            CheckpointNode cn = (*f)->GetNode(k);
+            if (merged.insert(ChVector2i(cn.i, cn.j)).second)
+                records.push_back(std::make_pair(f->get(), k));
+        }
+    }
+
+    std::vector<ChVector2i> lists_data[5];
+    const std::vector<ChVector2i>* lists[5];
+    for (int k = 0; k < 5; k++) {
+        lists_data[k] = last.GetLocations(k);
+        lists[k] = &lists_data[k];
+    }
+
+    CheckpointHeader hdr = last.GetHeader();
+    hdr.incremental = 0;
+    hdr.num_nodes = records.size();
+
+    size_t ir = 0;
+    auto nodes = [&](std::vector<CheckpointNode>& block) {
+        for (; ir < records.size() && block.size() < block.capacity(); ir++)
+            block.push_back(records[ir].first->GetNode(records[ir].second));
+        return ir < records.size();
+    };
+    WriteCheckpointFile(filename, hdr, nodes, lists);
+}
+
+// Start tracking the tiles modified after a checkpoint of the given chain.
+// Tiles covering the patch are flagged in a dense array (so that flagging is cheap in the SCM step); tiles outside the
+// patch are rare and are kept in a set.
+void SCMLoaderOld::ResetCheckpointTracking(std::uint64_t chain, std::uint32_t sequence) {
+    m_ckpt_chain = chain;
+    m_ckpt_sequence = sequence;
+    m_ckpt_origin = IndexBucket(ChVector2i(-m_nx, -m_ny), index_bucket);
+    ChVector2i last = IndexBucket(ChVector2i(m_nx, m_ny), index_bucket);
+    m_ckpt_ntx = last.x() - m_ckpt_origin.x() + 1;
+    m_ckpt_nty = last.y() - m_ckpt_origin.y() + 1;
+    m_ckpt_dirty.assign(m_ckpt_ntx * m_ckpt_nty, false);
+    m_ckpt_tiles.clear();
+    m_ckpt_outside.clear();
+}
+
+// Flag the tile containing the given grid node as modified since the last checkpoint.
+void SCMLoaderOld::MarkCheckpointNode(const ChVector2i& ij) {
+    if (m_ckpt_dirty.empty())
+        return;
+    ChVector2i tile = IndexBucket(ij, index_bucket);
+    int tx = tile.x() - m_ckpt_origin.x();
+    int ty = tile.y() - m_ckpt_origin.y();
+    if (tx < 0 || tx >= m_ckpt_ntx || ty < 0 || ty >= m_ckpt_nty) {
+        m_ckpt_outside.insert(tile);
+        return;
+    }
+    int it = tx + m_ckpt_ntx * ty;
+    if (!m_ckpt_dirty[it]) {
+        m_ckpt_dirty[it] = true;
+        m_ckpt_tiles.push_back(tile);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Deformation recording and replay
+// -----------------------------------------------------------------------------
+
+// Reset all grid nodes to the undeformed terrain and clear the grid map and spatial index.
+// Visualization outputs are first brought to the undeformed terrain at all recorded grid nodes.
+void SCMLoaderOld::ClearGridMap(std::vector<ChVector2i>& nodes) {
+    size_t first = nodes.size();
+    nodes.reserve(first + m_grid_map.size());
+    for (auto& n : m_grid_map) {
+        double z = GetInitHeight(n.first);
+        n.second = NodeRecord(z, z, GetInitNormal(n.first));
+        nodes.push_back(n.first);
+    }
+    if (m_trimesh_shape || m_heightfield || m_traversability) {
+        for (size_t k = first; k < nodes.size(); k++)
+            MarkVisualizationNode(nodes[k]);
+        UpdateVisualization();
+    }
+
+    m_grid_map.clear();
+    m_node_index.clear();
+
+    // Removed nodes cannot be represented in incremental checkpoints (a new chain must be started)
+    m_ckpt_dirty.clear();
+    m_ckpt_tiles.clear();
+    m_ckpt_outside.clear();
+}
+
+// Start recording the terrain deformation to a log file.
+// The log file starts with a header identifying the terrain patch; each frame is written as a frame header followed
+// by the node levels encoded in the compact delta format.
+void SCMLoaderOld::StartRecording(const std::string& filename,
+                                  int keyframe_interval,
+                                  double resolution,
+                                  int buffer_frames) {
+    if (keyframe_interval < 1 || !(resolution > 0) || buffer_frames < 1) {
+        std::cerr << "Invalid SCM recording parameters" << std::endl;
+        throw std::runtime_error("Invalid SCM recording parameters");
+    }
+    StopRecording();
+
+    FILE* file = std::fopen(filename.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Error in opening SCM deformation log " << filename << std::endl;
+        throw std::runtime_error("Cannot open SCM deformation log");
+    }
+
+    RecordingHeader hdr;
+    std::memset(&hdr, 0, sizeof(hdr));
+    std::memcpy(hdr.magic, "SCMRLOG", 8);
+    hdr.version = RecordingHeader::current_version;
+    hdr.header_size = sizeof(RecordingHeader);
+    hdr.type = static_cast<std::int32_t>(m_type);
+    hdr.nx = m_nx;
+    hdr.ny = m_ny;
+    hdr.keyframe_interval = keyframe_interval;
+    hdr.delta = m_delta;
+    hdr.resolution = resolution;
+    if (std::fwrite(&hdr, sizeof(hdr), 1, file) != 1) {
+        std::fclose(file);
+        std::cerr << "Error in writing SCM deformation log " << filename << std::endl;
+        throw std::runtime_error("Cannot write SCM deformation log");
+    }
+
+    m_recorder = chrono_types::make_unique<DeformationRecorder>();
+    auto rec = m_recorder.get();
+    rec->file = file;
+    rec->resolution = resolution;
+    rec->keyframe_interval = keyframe_interval;
+    rec->ring.resize(buffer_frames);
+
+    // Background writer: consume queued frames in order, then exit once stopped and drained.
+    // An error stops writing, but frames are still consumed so that the simulation never blocks.
+    rec->writer = std::thread([rec]() {
+        while (true) {
+            bool stopping = rec->stop.load(std::memory_order_acquire);
+            std::uint64_t tail = rec->tail.load(std::memory_order_relaxed);
+            if (tail == rec->head.load(std::memory_order_acquire)) {
+                if (stopping)
+                    break;
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                continue;
+            }
+            const auto& frame = rec->ring[tail % rec->ring.size()];
+            if (!rec->failed) {
+                rec->failed = std::fwrite(&frame.info, sizeof(frame.info), 1, rec->file) != 1 ||
+                              std::fwrite(frame.data.data(), 1, frame.data.size(), rec->file) != frame.data.size();
+            }
+            rec->tail.store(tail + 1, std::memory_order_release);
+        }
+    });
+}
+
+// Stop recording the terrain deformation, after all queued frames were written.
+void SCMLoaderOld::StopRecording() {
+    if (!m_recorder)
+        return;
+
+    m_recorder->stop.store(true, std::memory_order_release);
+    m_recorder->writer.join();
+    bool failed = m_recorder->failed;
+    if (std::fclose(m_recorder->file) != 0)
+        failed = true;
+    m_recorder.reset();
+
+    if (failed) {
+        std::cerr << "Error in writing SCM deformation log" << std::endl;
+        throw std::runtime_error("Cannot write SCM deformation log");
+    }
+}
+
+// Record the grid nodes modified over the current step (all grid nodes for a keyframe).
+// If the ring buffer is full, block until the background thread has written the oldest frame (no frame is dropped, so
+// that every step can be replayed).
+void SCMLoaderOld::RecordStep() {
+    auto& rec = *m_recorder;
+
+    std::uint64_t head = rec.head.load(std::memory_order_relaxed);
+    while (head - rec.tail.load(std::memory_order_acquire) >= rec.ring.size())
+        std::this_thread::yield();
+
+    auto& frame = rec.ring[head % rec.ring.size()];
+    bool keyframe = rec.force_keyframe || rec.step % rec.keyframe_interval == 0;
+    EncodeModifiedNodes(frame.data, rec.resolution, keyframe);
+    frame.info.step = rec.step;
+    frame.info.time = GetSystem()->GetChTime();
+    frame.info.keyframe = keyframe;
+    frame.info.size = static_cast<std::uint32_t>(frame.data.size());
+
+    rec.head.store(head + 1, std::memory_order_release);
+    rec.step++;
+    rec.force_keyframe = false;
+}
+
+// Apply a recorded frame.
+// A keyframe replaces all grid nodes; other frames modify the recorded nodes only. The recorded nodes are reported as
+// the nodes modified over the last step. The frame is validated before the terrain is modified.
+void SCMLoaderOld::ApplyRecordedFrame(const std::uint8_t* data, size_t size, bool keyframe) {
+    DecodeModifiedNodes(data, size, [](const ChVector2i&, double) {});
+
+    // Collect any deferred bulldozing job and discard the erosion domain (node records are replaced)
+    ResetErosionDomain();
+
+    std::vector<ChVector2i> changed;
+    if (keyframe) {
+        ClearGridMap(changed);
+        m_stats = SCMTerrainOld::DeformationStats();
+    }
+
+    m_modified_nodes.clear();
+    SetNodeLevels([&](auto set) {
+        DecodeModifiedNodes(data, size, [&](const ChVector2i& ij, double level) {
+            set(ij, level);
+            m_modified_nodes.push_back(ij);
+        });
+    });
+
+    if (m_state_snapshots) {
+        MarkSnapshotNodes(changed);
+        PublishStateSnapshot();
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Domain decomposition across processes
+// -----------------------------------------------------------------------------
+
+// Header of the shared-memory segment of a domain decomposition.
+// The segment is zero-filled on creation; the first process to attach takes ownership of it, fills in the layout, and
+// marks the segment ready. The header is followed by one slot per subdomain for each step parity. A slot consists of
+// a SubdomainSlotHeader, the published node records (CheckpointNode), the partial forces on shared bodies
+// (SubdomainBodySlot), and the material sent to the owners of ghost nodes (SubdomainRaise).
+// The synchronization fields are plain integers (no object is constructed in the segment), only accessed through the
+// atomic operations below.
+struct SubdomainSegmentHeader {
+    std::uint32_t owner;         // process which initialized the segment (0: none yet)
+    std::uint32_t ready;         // layout filled in?
+    std::uint32_t attached;      // number of attached processes
+    std::uint32_t arrived;       // number of processes waiting at the barrier
+    std::uint32_t generation;    // barrier generation
+    std::uint32_t version;       // segment layout version
+    std::int32_t num_x;          // number of subdomains in X direction
+    std::int32_t num_y;          // number of subdomains in Y direction
+    std::int32_t nx;             // range for grid indices in X direction
+    std::int32_t ny;             // range for grid indices in Y direction
+    std::int32_t halo;           // width of the ghost layer
+    std::int32_t max_bodies;     // number of shared body slots
+    std::uint64_t segment_size;  // size of the shared-memory segment
+};
+
+// Header of a subdomain slot
+struct SubdomainSlotHeader {
+    std::uint64_t count;       // number of published node records
+    std::uint64_t step;        // exchange step
+    std::uint64_t num_raised;  // number of material transfers
+};
+
+// Partial contact force on a shared body
+struct SubdomainBodySlot {
+    double force[3];       // force (expressed in global frame)
+    double torque[3];      // torque about the body COM (expressed in global frame)
+    std::uint32_t active;  // contact forces computed by this subdomain?
+    std::uint32_t padding;
+};
+
+// Material added by bulldozing to a ghost node, to be applied by the owner of the node
+struct SubdomainRaise {
+    std::int32_t i;  // grid node X index
+    std::int32_t j;  // grid node Y index
+    double amount;   // raise amount
+};
+
+static const std::uint32_t subdomain_segment_version = 1;
+static const size_t subdomain_header_size = 128;  // size reserved for the segment header
+static const double subdomain_timeout = 60;       // maximum wait for other processes (s)
+
+static_assert(sizeof(SubdomainSegmentHeader) <= subdomain_header_size, "SCM segment header too large");
+
+#ifndef _WIN32
+
+// Atomic operations on the synchronization fields of the segment header (shared by all processes)
+static std::uint32_t SegmentLoad(const std::uint32_t& field) {
+    return __atomic_load_n(&field, __ATOMIC_ACQUIRE);
+}
+
+static void SegmentStore(std::uint32_t& field, std::uint32_t val) {
+    __atomic_store_n(&field, val, __ATOMIC_RELEASE);
+}
+
+static std::uint32_t SegmentFetchAdd(std::uint32_t& field, std::uint32_t val) {
+    return __atomic_fetch_add(&field, val, __ATOMIC_ACQ_REL);
+}
+
+static bool SegmentCompareExchange(std::uint32_t& field, std::uint32_t expected, std::uint32_t val) {
+    return __atomic_compare_exchange_n(&field, &expected, val, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+// Check whether the given process is still running (a process of another user is reported as running).
+static bool ProcessRunning(std::uint32_t pid) {
+    return kill((pid_t)pid, 0) == 0 || errno != ESRCH;
+}
+
+#endif
+
+// Wait until the given condition holds, yielding to other threads; throw if other processes do not respond.
+template <typename Condition>
+static void WaitSubdomains(Condition condition) {
+    auto start = std::chrono::steady_clock::now();
+    while (!condition()) {
+        std::this_thread::yield();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() > subdomain_timeout) {
+            std::cerr << "Timeout in waiting for SCM subdomain processes" << std::endl;
+            throw std::runtime_error("Timeout in waiting for SCM subdomain processes");
+        }
+    }
+}
+
+// Split the grid into subdomains and attach to the shared-memory segment.
+// All processes open (and possibly create) the segment with the same size. The first process to attach fills in the
+// segment layout, which the others check against their own. Once all processes attached, the segment name is removed,
+// so that the segment is released when the last process detaches. A segment left over by an interrupted run (its
+// owner is no longer running) is rejected right away and its name removed, so that the decomposition can be set up
+// again.
+void SCMLoaderOld::SetDomainDecomposition(const std::string& name,
+                                          int num_x,
+                                          int num_y,
+                                          int rank,
+                                          int halo,
+                                          int max_bodies) {
+#ifdef _WIN32
+    std::cerr << "SCM domain decomposition is not supported on this platform" << std::endl;
+    throw std::runtime_error("SCM domain decomposition is not supported on this platform");
+#else
+    if (num_x < 1 || num_y < 1 || num_x > 2 * m_nx + 1 || num_y > 2 * m_ny + 1 || rank < 0 ||
+        rank >= num_x * num_y || halo < 1 || max_bodies < 0) {
+        std::cerr << "Invalid SCM domain decomposition" << std::endl;
+        throw std::runtime_error("Invalid SCM domain decomposition");
+    }
+
+    // A deferred bulldozing job reads the current decomposition
+    WaitBulldozing();
+    if (m_decomposition)
+        CloseDomainDecomposition();
+
+    auto dd = chrono_types::make_unique<DomainDecomposition>();
+    dd->name = (name.empty() || name[0] != '/') ? "/" + name : name;
+    dd->num_x = num_x;
+    dd->num_y = num_y;
+    dd->rank = rank;
+    dd->halo = halo;
+    dd->max_bodies = max_bodies;
+    m_decomposition = std::move(dd);
+
+    auto& d = *m_decomposition;
+    GetSubdomainRange(rank, d.own_min, d.own_max);
+    d.local_min = ChVector2i(std::max(d.own_min.x() - halo, -m_nx), std::max(d.own_min.y() - halo, -m_ny));
+    d.local_max = ChVector2i(std::min(d.own_max.x() + halo, m_nx), std::min(d.own_max.y() + halo, m_ny));
+
+    // A subdomain publishes at most its nodes within 'halo' of its sides
+    size_t w = (2 * m_nx + num_x) / num_x;  // maximum number of subdomain nodes in X direction
+    size_t h = (2 * m_ny + num_y) / num_y;  // maximum number of subdomain nodes in Y direction
+    d.halo_capacity = std::min(w * h, 2 * (size_t)halo * (w + h));
+    // Material is sent at most to the ghost nodes of the subdomain
+    d.raise_capacity = 2 * (size_t)halo * (w + h + 2 * (size_t)halo);
+    d.slot_size = sizeof(SubdomainSlotHeader) + d.halo_capacity * sizeof(CheckpointNode) +
+                  (size_t)max_bodies * sizeof(SubdomainBodySlot) + d.raise_capacity * sizeof(SubdomainRaise);
+    d.slot_size = (d.slot_size + 63) / 64 * 64;
+    d.segment_size = subdomain_header_size + 2 * (size_t)(num_x * num_y) * d.slot_size;
+
+    // Open and map the shared-memory segment
+    int fd = shm_open(d.name.c_str(), O_CREAT | O_RDWR, 0600);
+    bool ok = fd >= 0 && ftruncate(fd, (off_t)d.segment_size) == 0;
+    if (ok) {
+        void* addr = mmap(nullptr, d.segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ok = addr != MAP_FAILED;
+        if (ok)
+            d.segment = static_cast<char*>(addr);
+    }
+    if (fd >= 0)
+        close(fd);
+    if (!ok) {
+        std::cerr << "Error in opening SCM shared-memory segment " << d.name << std::endl;
+        m_decomposition.reset();
+        throw std::runtime_error("Cannot open SCM shared-memory segment");
+    }
+
+    // Fill in or check the segment layout
+    auto hdr = reinterpret_cast<SubdomainSegmentHeader*>(d.segment);
+    if (SegmentCompareExchange(hdr->owner, 0, (std::uint32_t)getpid())) {
+        hdr->version = subdomain_segment_version;
+        hdr->num_x = num_x;
+        hdr->num_y = num_y;
+        hdr->nx = m_nx;
+        hdr->ny = m_ny;
+        hdr->halo = halo;
+        hdr->max_bodies = max_bodies;
+        hdr->segment_size = d.segment_size;
+        SegmentStore(hdr->ready, 1);
+    }
+    std::uint32_t owner = SegmentLoad(hdr->owner);
+    try {
+        WaitSubdomains([hdr, owner]() { return SegmentLoad(hdr->ready) == 1 || !ProcessRunning(owner); });
+    } catch (std::exception&) {
+        CloseDomainDecomposition();
+        throw;
+    }
+
+    if (!ProcessRunning(owner)) {
+        std::cerr << "Stale SCM shared-memory segment " << d.name << " (owner process " << owner
+                  << " terminated); segment removed" << std::endl;
+        shm_unlink(d.name.c_str());
+        CloseDomainDecomposition();
+        throw std::runtime_error("Stale SCM shared-memory segment");
+    }
+
+    if (hdr->version != subdomain_segment_version || hdr->num_x != num_x || hdr->num_y != num_y ||
+        hdr->nx != m_nx || hdr->ny != m_ny || hdr->halo != halo || hdr->max_bodies != max_bodies ||
+        hdr->segment_size != d.segment_size || SegmentFetchAdd(hdr->attached, 1) >= (std::uint32_t)(num_x * num_y)) {
+        std::cerr << "Inconsistent SCM domain decomposition in shared-memory segment " << d.name << std::endl;
+        CloseDomainDecomposition();
+        throw std::runtime_error("Inconsistent SCM domain decomposition");
+    }
+
+    // Wait for all processes, then remove the segment name
+    try {
+        SubdomainBarrier();
+    } catch (std::exception&) {
+        CloseDomainDecomposition();
+        throw;
+    }
+    if (rank == 0)
+        shm_unlink(d.name.c_str());
+
+    // Ray casting is now restricted to the local subdomain; rebuild the erosion domain accordingly
+    ResetErosionDomain();
+#endif
+}
+
+// Detach from the shared-memory segment of the domain decomposition.
+void SCMLoaderOld::CloseDomainDecomposition() {
+#ifndef _WIN32
+    if (m_decomposition->segment)
+        munmap(m_decomposition->segment, m_decomposition->segment_size);
+#endif
+    m_decomposition.reset();
+}
+
+// Get the range of grid indices owned by the given subdomain.
+// The grid nodes in each direction are split as evenly as possible.
+void SCMLoaderOld::GetSubdomainRange(int rank, ChVector2i& min, ChVector2i& max) const {
+    const auto& dd = *m_decomposition;
+    std::int64_t nnx = 2 * m_nx + 1;
+    std::int64_t nny = 2 * m_ny + 1;
+    std::int64_t px = rank % dd.num_x;
+    std::int64_t py = rank / dd.num_x;
+    min = ChVector2i(-m_nx + (int)(nnx * px / dd.num_x), -m_ny + (int)(nny * py / dd.num_y));
+    max = ChVector2i(-m_nx + (int)(nnx * (px + 1) / dd.num_x) - 1, -m_ny + (int)(nny * (py + 1) / dd.num_y) - 1);
+}
+
+// Get the subdomain containing the given grid node (clamped to the grid).
+int SCMLoaderOld::GetSubdomain(const ChVector2i& ij) const {
+    const auto& dd = *m_decomposition;
+    std::int64_t nnx = 2 * m_nx + 1;
+    std::int64_t nny = 2 * m_ny + 1;
+    std::int64_t kx = ChClamp(ij.x(), -m_nx, m_nx) + m_nx;
+    std::int64_t ky = ChClamp(ij.y(), -m_ny, m_ny) + m_ny;
+    int px = (int)((dd.num_x * (kx + 1) - 1) / nnx);
+    int py = (int)((dd.num_y * (ky + 1) - 1) / nny);
+    return py * dd.num_x + px;
+}
+
+// Wait until all processes of the domain decomposition reach this point (central barrier).
+// The last process to arrive resets the arrival count and starts a new barrier generation.
+void SCMLoaderOld::SubdomainBarrier() {
+#ifndef _WIN32
+    auto hdr = reinterpret_cast<SubdomainSegmentHeader*>(m_decomposition->segment);
+    std::uint32_t num_ranks = (std::uint32_t)(m_decomposition->num_x * m_decomposition->num_y);
+    std::uint32_t generation = SegmentLoad(hdr->generation);
+    if (SegmentFetchAdd(hdr->arrived, 1) + 1 == num_ranks) {
+        SegmentStore(hdr->arrived, 0);
+        SegmentFetchAdd(hdr->generation, 1);
+        return;
+    }
+    WaitSubdomains([hdr, generation]() { return SegmentLoad(hdr->generation) != generation; });
+#endif
+}
+
+// Exchange ghost nodes and shared body forces with the other subdomains.
+// Slots are double-buffered by step parity, so that a single barrier per step is needed: a process can only write
+// the slots of a given parity again after all processes passed the next barrier, i.e. finished reading them.
+void SCMLoaderOld::ExchangeSubdomains() {
+    auto& dd = *m_decomposition;
+    const int num_ranks = dd.num_x * dd.num_y;
+    const int parity = (int)(dd.step & 1);
+
+    auto slot = [&](int r) {
+        return dd.segment + subdomain_header_size + (size_t)(parity * num_ranks + r) * dd.slot_size;
+    };
+    auto slot_nodes = [&](char* s) { return reinterpret_cast<CheckpointNode*>(s + sizeof(SubdomainSlotHeader)); };
+    auto slot_bodies = [&](char* s) {
+        return reinterpret_cast<SubdomainBodySlot*>(s + sizeof(SubdomainSlotHeader) +
+                                                    dd.halo_capacity * sizeof(CheckpointNode));
+    };
+    auto slot_raised = [&](char* s) {
+        return reinterpret_cast<SubdomainRaise*>(s + sizeof(SubdomainSlotHeader) +
+                                                 dd.halo_capacity * sizeof(CheckpointNode) +
+                                                 (size_t)dd.max_bodies * sizeof(SubdomainBodySlot));
+    };
+
+    // Publish the owned nodes modified over this step within the ghost layer of a neighboring subdomain.
+    // Nodes published at the last exchange are published again, since they were since reset (ComputeInternalForces);
+    // so are owned nodes which received material after the last publication.
+    std::vector<ChVector2i> published;
+    for (const auto& ij : m_modified_nodes) {
+        if (GetSubdomain(ij) != dd.rank)
+            continue;
+        bool ghost = (ij.x() < dd.own_min.x() + dd.halo && dd.own_min.x() > -m_nx) ||
+                     (ij.x() > dd.own_max.x() - dd.halo && dd.own_max.x() < m_nx) ||
+                     (ij.y() < dd.own_min.y() + dd.halo && dd.own_min.y() > -m_ny) ||
+                     (ij.y() > dd.own_max.y() - dd.halo && dd.own_max.y() < m_ny);
+        if (ghost)
+            published.push_back(ij);
+    }
+    std::vector<ChVector2i> republished;
+    std::set_difference(dd.published.begin(), dd.published.end(), published.begin(), published.end(),
+                        std::back_inserter(republished), CoordLess());
+
+    char* own = slot(dd.rank);
+    auto own_nodes = slot_nodes(own);
+    size_t count = 0;
+    for (const auto& ij : published)
+        own_nodes[count++] = PackCheckpointNode(ij, m_grid_map.at(ij));
+    for (const auto& ij : republished)
+        own_nodes[count++] = PackCheckpointNode(ij, m_grid_map.at(ij));
+    dd.published = std::move(published);
+
+    // Publish the material added to ghost nodes by bulldozing (accumulated per node)
+    std::stable_sort(dd.raised.begin(), dd.raised.end(),
+                     [](const std::pair<ChVector2i, double>& a, const std::pair<ChVector2i, double>& b) {
+                         return CoordLess()(a.first, b.first);
+                     });
+    auto own_raised = slot_raised(own);
+    size_t num_raised = 0;
+    for (size_t k = 0; k < dd.raised.size();) {
+        ChVector2i ij = dd.raised[k].first;
+        double amount = 0;
+        for (; k < dd.raised.size() && dd.raised[k].first == ij; k++)
+            amount += dd.raised[k].second;
+        own_raised[num_raised++] = {ij.x(), ij.y(), amount};
+    }
+    dd.raised.clear();
+
+    auto own_hdr = reinterpret_cast<SubdomainSlotHeader*>(own);
+    own_hdr->count = count;
+    own_hdr->step = dd.step;
+    own_hdr->num_raised = num_raised;
+
+    // Publish the partial contact forces on shared bodies
+    auto own_bodies = slot_bodies(own);
+    for (int id = 0; id < dd.max_bodies; id++)
+        own_bodies[id].active = 0;
+    for (const auto& b : dd.bodies) {
+        auto itr = m_body_forces.find(b.first);
+        if (itr == m_body_forces.end())
+            continue;
+        auto& bs = own_bodies[b.second];
+        for (int k = 0; k < 3; k++) {
+            bs.force[k] = itr->second.first[k];
+            bs.torque[k] = itr->second.second[k];
+        }
+        bs.active = 1;
+    }
+
+    SubdomainBarrier();
+
+    // Collect the node records published by neighboring subdomains within the local ghost layer, and the material sent
+    // to owned nodes
+    for (int r = 0; r < num_ranks; r++) {
+        if (r == dd.rank)
+            continue;
+        ChVector2i min, max;
+        GetSubdomainRange(r, min, max);
+        if (max.x() < dd.local_min.x() || min.x() > dd.local_max.x() || max.y() < dd.local_min.y() ||
+            min.y() > dd.local_max.y())
+            continue;
+        char* other = slot(r);
+        auto other_hdr = reinterpret_cast<SubdomainSlotHeader*>(other);
+        auto other_nodes = slot_nodes(other);
+        for (size_t k = 0; k < other_hdr->count; k++) {
+            const auto& cn = other_nodes[k];
+            if (cn.i >= dd.local_min.x() && cn.i <= dd.local_max.x() && cn.j >= dd.local_min.y() &&
+                cn.j <= dd.local_max.y())
+                dd.ghosts.push_back(cn);
+        }
+        auto other_raised = slot_raised(other);
+        for (size_t k = 0; k < other_hdr->num_raised; k++) {
+            ChVector2i ij(other_raised[k].i, other_raised[k].j);
+            if (GetSubdomain(ij) == dd.rank)
+                dd.received.push_back(std::make_pair(ij, other_raised[k].amount));
+        }
+    }
+
+    // Reduce the contact forces on shared bodies at their owner; other subdomains do not apply these forces
+    for (const auto& b : dd.bodies) {
+        ChBody* body = b.first;
+        auto pos = m_frame.TransformPointParentToLocal(body->GetPos());
+        ChVector2i ij((int)std::round(pos.x() / m_delta), (int)std::round(pos.y() / m_delta));
+        if (GetSubdomain(ij) != dd.rank) {
+            m_body_forces.erase(body);
+            continue;
+        }
+
+        ChVector3d force(0, 0, 0);
+        ChVector3d torque(0, 0, 0);
+        bool active = false;
+        for (int r = 0; r < num_ranks; r++) {
+            const auto& bs = slot_bodies(slot(r))[b.second];
+            if (!bs.active)
+                continue;
+            force += ChVector3d(bs.force[0], bs.force[1], bs.force[2]);
+            torque += ChVector3d(bs.torque[0], bs.torque[1], bs.torque[2]);
+            active = true;
+        }
+        if (!active)
+            continue;
+        m_body_forces[body] = std::make_pair(force, torque);
+
+        if (!m_cosim_mode) {
+            std::shared_ptr<ChBody> sbody(body, [](ChBody*) {});
+            auto force_load = chrono_types::make_shared<ChLoadBodyForce>(sbody, force, false, sbody->GetPos(), false);
+            auto torque_load = chrono_types::make_shared<ChLoadBodyTorque>(sbody, torque, false);
+            Add(force_load);
+            Add(torque_load);
+        }
+    }
+
+    dd.step++;
+
+    // Apply the received data now, unless a deferred bulldozing job is reading the grid map: the data is then applied
+    // once the job completes (see WaitBulldozing), at the latest at the start of the next step, and the nodes it
+    // modifies are reported with that step.
+    if (m_bulldozing_future.valid())
+        return;
+    ApplySubdomainExchange();
+    m_modified_nodes.insert(m_modified_nodes.end(), dd.applied.begin(), dd.applied.end());
+    dd.applied.clear();
+
+    // Ghost nodes may also have been modified locally (bulldozing)
+    UniqueModifiedNodes();
+}
+
+// Apply the ghost node records and the material received from other subdomains.
+// The local erosion state of the ghost nodes is kept, so that the cached erosion domain remains valid. Aggregate
+// statistics follow the changes of the local grid.
+void SCMLoaderOld::ApplySubdomainExchange() {
+    auto& dd = *m_decomposition;
+    if (dd.ghosts.empty() && dd.received.empty())
+        return;
+
+    auto record = [this, &dd](const ChVector2i& ij) -> NodeRecord& {
+        auto rec = m_grid_map.find(ij);
+        if (rec == m_grid_map.end()) {
+            double z = GetInitHeight(ij);
+            rec = m_grid_map.insert(std::make_pair(ij, NodeRecord(z, z, GetInitNormal(ij)))).first;
+            IndexNode(ij);
+        } else {
+            MarkCheckpointNode(ij);
+        }
+        dd.applied.push_back(ij);
+        return rec->second;
+    };
+
+    for (const auto& cn : dd.ghosts) {
+        auto& nr = record(ChVector2i(cn.i, cn.j));
+        double level_prev = nr.level;
+        double plastic_prev = nr.sinkage_plastic;
+        bool erosion = nr.erosion;
+        int erosion_hops = nr.erosion_hops;
+        UnpackCheckpointNode(cn, nr);
+        nr.erosion = erosion;
+        nr.erosion_hops = erosion_hops;
+        m_stats.net_volume += (nr.level - level_prev) * m_area;
+        m_stats.plastic_volume += (nr.sinkage_plastic - plastic_prev) * m_area;
+        m_stats.max_sinkage = std::max(m_stats.max_sinkage, nr.sinkage);
+    }
+    dd.ghosts.clear();
+
+    // Owned nodes which received material are published at the next exchange
+    for (const auto& r : dd.received) {
+        double deposited = AddMaterialToNode(r.second, record(r.first));
+        m_stats.deposited_volume += deposited * m_area;
+        m_stats.net_volume += deposited * m_area;
+        dd.published.push_back(r.first);
     }
+    dd.received.clear();
+    std::sort(dd.published.begin(), dd.published.end(), CoordLess());
+    dd.published.erase(std::unique(dd.published.begin(), dd.published.end()), dd.published.end());
 }
 
 }  // end namespace vehicle
@@ -0,0 +1,75 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All rights reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Test of the SCMTerrainOld deferred bulldozing: with the erosion phase run on a
+// background thread (applied at the start of the next step), the terrain must
+// evolve exactly as with synchronous bulldozing at the same rate.
+// =============================================================================
+
+#include <cmath>
+#include <memory>
+
+#include "utest_SCM_common.h"
+
+// Grid of the test terrain: 2 m x 2 m with 4 cm spacing
+static const double size = 2.0;
+static const double delta = 0.04;
+
+static const int num_steps = 120;
+static const double step_size = 1e-3;
+
+// Erosion performed every other step
+static const int interval = 2;
+
+// Position of the box at the given step: along a circle, so that the box crosses the ruts of previous steps.
+static ChVector3d BoxPos(int step) {
+    double angle = 0.06 * step;
+    return ChVector3d(0.5 * std::cos(angle), 0.5 * std::sin(angle), 0.08);
+}
+
+struct Setup {
+    Setup(bool async) {
+        sys.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+        box = AddBox(sys, ChVector3d(0.2, 0.2, 0.2), BoxPos(0));
+        box->SetFixed(true);
+        terrain = CreateTerrain(sys, size, size, delta);
+        terrain->EnableBulldozing(true);
+        terrain->SetBulldozingParameters(30, 1.2, 3, 6);
+        terrain->SetBulldozingRate(interval, async);
+    }
+
+    ChSystemSMC sys;
+    std::shared_ptr<ChBody> box;
+    std::unique_ptr<SCMTerrainOld> terrain;
+};
+
+int main() {
+    Setup sync(false);
+    Setup async(true);
+
+    bool same_levels = true;
+    for (int k = 0; k < num_steps; k++) {
+        sync.box->SetPos(BoxPos(k));
+        sync.sys.DoStepDynamics(step_size);
+        async.box->SetPos(BoxPos(k));
+        async.sys.DoStepDynamics(step_size);
+
+        // Complete the pending erosion job from time to time (otherwise applied at the start of the next step)
+        if ((k + 1) % 10 == 0) {
+            async.terrain->EnableBulldozing(true);
+            same_levels = same_levels && Matches(GetLevels(*sync.terrain), GetLevels(*async.terrain));
+        }
+    }
+    CHECK(!GetLevels(*sync.terrain).empty());
+    CHECK(same_levels);
+
+    return TestResult("SCM asynchronous bulldozing");
+}
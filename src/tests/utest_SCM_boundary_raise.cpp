@@ -0,0 +1,92 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All rights reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Test of the SCMTerrainOld bulldozing boundary raise, evaluated per contact
+// patch in parallel: a node on the boundary of two patches must receive the
+// material of both, and the deformation must not depend on the number of
+// threads.
+// =============================================================================
+
+#include <cmath>
+#include <memory>
+
+#include "utest_SCM_common.h"
+
+// Grid of the test terrain: 2 m x 2 m with 4 cm spacing
+static const double size = 2.0;
+static const double delta = 0.04;
+
+static const int num_steps = 60;
+static const double step_size = 1e-3;
+
+// Two boxes pressed 2 cm into the terrain, on each side of the grid column X = 0 (grid nodes -5..-1 and 1..5 in X
+// direction, -2..2 in Y direction at the first step), moving side by side in Y direction.
+static ChVector3d BoxPos(double x, int step) {
+    return ChVector3d(x, 0.01 * step, 0.08);
+}
+
+struct Setup {
+    Setup(int num_threads) {
+        sys.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+        sys.SetNumThreads(num_threads);
+        left = AddBox(sys, ChVector3d(0.2, 0.2, 0.2), BoxPos(-0.12, 0));
+        right = AddBox(sys, ChVector3d(0.2, 0.2, 0.2), BoxPos(0.12, 0));
+        left->SetFixed(true);
+        right->SetFixed(true);
+        terrain = CreateTerrain(sys, size, size, delta);
+        terrain->EnableBulldozing(true);
+        // Without erosion refinement, the displaced material stays on the patch boundaries and the deformation does
+        // not depend on the order of the contact patches
+        terrain->SetBulldozingParameters(30, 1.0, 0, 6);
+    }
+
+    void Advance(int step) {
+        left->SetPos(BoxPos(-0.12, step));
+        right->SetPos(BoxPos(0.12, step));
+        sys.DoStepDynamics(step_size);
+    }
+
+    ChSystemSMC sys;
+    std::shared_ptr<ChBody> left;
+    std::shared_ptr<ChBody> right;
+    std::unique_ptr<SCMTerrainOld> terrain;
+};
+
+int main() {
+    // Boundary raise at the first step
+    {
+        Setup setup(4);
+        setup.Advance(0);
+        auto levels = GetLevels(*setup.terrain);
+
+        // Grid nodes on the outer side of each patch, and between the two patches
+        double outer_left = levels[ChVector2i(-6, 0)];
+        double outer_right = levels[ChVector2i(6, 0)];
+        double shared = levels[ChVector2i(0, 0)];
+        CHECK(outer_left > 0);
+        CHECK(std::abs(outer_right - outer_left) <= 1e-9 * outer_left);
+        CHECK(std::abs(shared - (outer_left + outer_right)) <= 1e-9 * outer_left);
+    }
+
+    // Same deformation with one and several threads
+    Setup serial(1);
+    Setup parallel(4);
+    bool same_levels = true;
+    for (int k = 0; k < num_steps; k++) {
+        serial.Advance(k);
+        parallel.Advance(k);
+        same_levels = same_levels && Matches(GetLevels(*serial.terrain), GetLevels(*parallel.terrain), 1e-12);
+    }
+    CHECK(!GetLevels(*serial.terrain).empty());
+    CHECK(same_levels);
+
+    return TestResult("SCM parallel boundary raise");
+}
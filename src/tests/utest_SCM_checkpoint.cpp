@@ -0,0 +1,174 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All rights reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Round-trip test of SCMTerrainOld checkpoints: a full checkpoint extended by
+// incremental checkpoints is restored (as a chain and after compaction) into a
+// fresh terrain, which must reproduce the saved state exactly and evolve as the
+// original terrain afterwards.
+// =============================================================================
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "utest_SCM_common.h"
+
+// Grid of the test terrain: 2 m x 2 m with 5 cm spacing (node indices in [-20, 20])
+static const double size = 2.0;
+static const double delta = 0.05;
+static const int n = 20;
+
+static const double step_size = 1e-3;
+
+// Terrain with a box pressed into it at prescribed positions.
+struct Setup {
+    Setup() {
+        sys.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+        box = AddBox(sys, ChVector3d(0.3, 0.3, 0.2), ChVector3d(0, 0, 1));
+        box->SetFixed(true);
+        terrain = CreateTerrain(sys, size, size, delta);
+    }
+
+    // Press the box into the terrain at the given location, over the given number of steps.
+    void Deform(double x, double y, double depth, int num_steps) {
+        box->SetPos(ChVector3d(x, y, 0.1 - depth));
+        for (int k = 0; k < num_steps; k++)
+            sys.DoStepDynamics(step_size);
+    }
+
+    ChSystemSMC sys;
+    std::shared_ptr<ChBody> box;
+    std::unique_ptr<SCMTerrainOld> terrain;
+};
+
+// Terrain state compared by the test: node levels and all node quantities over the entire grid.
+struct State {
+    std::vector<SCMTerrainOld::NodeLevel> levels;
+    std::vector<double> fields[7];
+    SCMTerrainOld::DeformationStats stats;
+};
+
+static State GetState(const SCMTerrainOld& terrain) {
+    State s;
+    s.levels = terrain.GetModifiedNodes(true);
+    std::sort(s.levels.begin(), s.levels.end(),
+              [](const SCMTerrainOld::NodeLevel& a, const SCMTerrainOld::NodeLevel& b) {
+                  return a.first.y() < b.first.y() || (a.first.y() == b.first.y() && a.first.x() < b.first.x());
+              });
+
+    const int width = 2 * n + 1;
+    for (auto& f : s.fields)
+        f.resize(width * width);
+    SCMTerrainOld::NodeInfoBuffers buffers;
+    buffers.sinkage = s.fields[0].data();
+    buffers.sinkage_plastic = s.fields[1].data();
+    buffers.sinkage_elastic = s.fields[2].data();
+    buffers.sigma = s.fields[3].data();
+    buffers.sigma_yield = s.fields[4].data();
+    buffers.kshear = s.fields[5].data();
+    buffers.tau = s.fields[6].data();
+    terrain.ExportNodeInfo(ChVector2i(-n, -n), width, width, buffers);
+
+    s.stats = terrain.GetDeformationStats();
+    return s;
+}
+
+static bool Identical(const State& a, const State& b) {
+    if (a.levels.size() != b.levels.size())
+        return false;
+    for (size_t k = 0; k < a.levels.size(); k++) {
+        if (a.levels[k].first != b.levels[k].first || a.levels[k].second != b.levels[k].second)
+            return false;
+    }
+    for (int f = 0; f < 7; f++) {
+        if (a.fields[f] != b.fields[f])
+            return false;
+    }
+    return a.stats.plastic_volume == b.stats.plastic_volume && a.stats.net_volume == b.stats.net_volume &&
+           a.stats.max_sinkage == b.stats.max_sinkage;
+}
+
+int main() {
+    const std::vector<std::string> chain = {"scm_ckpt_0.dat", "scm_ckpt_1.dat", "scm_ckpt_2.dat"};
+    const std::string compacted = "scm_ckpt_compacted.dat";
+    const std::string truncated = "scm_ckpt_truncated.dat";
+
+    // Source terrain: full checkpoint, then two deltas after deformation at partially overlapping locations
+    Setup source;
+    CHECK(Throws([&]() { source.terrain->WriteCheckpointDelta(chain[1]); }));  // no chain started yet
+
+    source.Deform(-0.4, -0.3, 0.02, 20);
+    source.terrain->WriteCheckpoint(chain[0]);
+    source.Deform(-0.2, -0.2, 0.03, 20);
+    source.Deform(0.6, 0.6, 0.01, 10);
+    source.terrain->WriteCheckpointDelta(chain[1]);
+    source.Deform(0.1, -0.8, 0.04, 20);
+    source.terrain->WriteCheckpointDelta(chain[2]);
+    auto saved = GetState(*source.terrain);
+    CHECK(!saved.levels.empty());
+
+    // An incomplete chain restores an earlier state
+    {
+        Setup partial;
+        partial.terrain->ReadCheckpoint(std::vector<std::string>(chain.begin(), chain.begin() + 2));
+        CHECK(!Identical(saved, GetState(*partial.terrain)));
+    }
+
+    // Compact the chain and restore the single checkpoint
+    SCMTerrainOld::CompactCheckpoints(chain, compacted);
+    {
+        Setup restored;
+        restored.terrain->ReadCheckpoint(compacted);
+        CHECK(Identical(saved, GetState(*restored.terrain)));
+    }
+
+    // Restore the chain into a fresh terrain, then continue both terrains identically (node levels may differ by
+    // round-off, as the restored grid map is visited in a different order)
+    {
+        Setup restored;
+        restored.terrain->ReadCheckpoint(chain);
+        CHECK(Identical(saved, GetState(*restored.terrain)));
+
+        source.Deform(-0.1, -0.3, 0.04, 20);
+        restored.Deform(-0.1, -0.3, 0.04, 20);
+        CHECK(Matches(GetLevels(*source.terrain), GetLevels(*restored.terrain), 1e-12));
+    }
+
+    // Truncated and mismatched checkpoints are rejected
+    {
+        std::ifstream in(chain[0], std::ios::binary);
+        std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(truncated, std::ios::binary);
+        out.write(data.data(), data.size() / 2);
+    }
+    {
+        ChSystemSMC sys;
+        sys.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+        auto fresh = CreateTerrain(sys, size, size, delta);
+        CHECK(Throws([&]() { fresh->ReadCheckpoint(truncated); }));
+        CHECK(Throws([&]() { fresh->ReadCheckpoint(std::vector<std::string>{chain[0], chain[2]}); }));
+
+        SCMTerrainOld other(&sys, false);
+        other.Initialize(size, size, 2 * delta);
+        CHECK(Throws([&]() { other.ReadCheckpoint(chain[0]); }));
+    }
+
+    for (const auto& f : chain)
+        std::remove(f.c_str());
+    std::remove(compacted.c_str());
+    std::remove(truncated.c_str());
+
+    return TestResult("SCM checkpoint round trip");
+}
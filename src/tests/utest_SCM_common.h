@@ -0,0 +1,126 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All rights reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Common scaffolding of the SCMTerrainOld unit tests: failure checks, test
+// terrains and bodies, and comparison of node levels.
+// =============================================================================
+
+#ifndef UTEST_SCM_COMMON_H
+#define UTEST_SCM_COMMON_H
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "chrono/physics/ChBodyEasy.h"
+#include "chrono/physics/ChContactMaterialSMC.h"
+#include "chrono/physics/ChSystemSMC.h"
+
+#include "chrono_gpu_scm/SCMTerrainOld.h"
+
+using namespace chrono;
+using namespace chrono::vehicle;
+
+// Number of failed checks
+static int num_failures = 0;
+
+#define CHECK(cond)                                                                      \
+    do {                                                                                 \
+        if (!(cond)) {                                                                   \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": failed: " #cond << std::endl; \
+            num_failures++;                                                              \
+        }                                                                                \
+    } while (0)
+
+// Report the outcome of the test and return its exit code.
+inline int TestResult(const std::string& name) {
+    if (num_failures > 0) {
+        std::cerr << num_failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << name << ": OK" << std::endl;
+    return 0;
+}
+
+// Create a flat terrain without visualization mesh in the given system.
+inline std::unique_ptr<SCMTerrainOld> CreateTerrain(ChSystem& sys, double size_x, double size_y, double delta) {
+    auto terrain = chrono_types::make_unique<SCMTerrainOld>(&sys, false);
+    terrain->SetSoilParameters(2e6, 0, 1.1, 0, 30, 0.01, 2e8, 3e4);
+    terrain->Initialize(size_x, size_y, delta);
+    return terrain;
+}
+
+// Add a box with collision geometry (no visualization) to the given system.
+inline std::shared_ptr<ChBody> AddBox(ChSystem& sys, const ChVector3d& size, const ChVector3d& pos) {
+    auto material = chrono_types::make_shared<ChContactMaterialSMC>();
+    auto box = chrono_types::make_shared<ChBodyEasyBox>(size.x(), size.y(), size.z(),  // dimensions
+                                                         5000,                          // density
+                                                         false,                         // no visualization asset
+                                                         true,                          // collision geometry
+                                                         material);
+    box->SetPos(pos);
+    sys.Add(box);
+    return box;
+}
+
+// Check whether the given function throws an exception.
+template <typename Function>
+bool Throws(Function f) {
+    try {
+        f();
+    } catch (std::exception&) {
+        return true;
+    }
+    return false;
+}
+
+// Grid node ordering used to compare node lists (row after row).
+struct Less {
+    bool operator()(const ChVector2i& a, const ChVector2i& b) const {
+        return a.y() < b.y() || (a.y() == b.y() && a.x() < b.x());
+    }
+};
+
+typedef std::map<ChVector2i, double, Less> LevelMap;
+
+inline LevelMap ToMap(const std::vector<SCMTerrainOld::NodeLevel>& nodes) {
+    LevelMap map;
+    for (const auto& n : nodes)
+        map[n.first] = n.second;
+    return map;
+}
+
+// Levels of all grid nodes modified from the start of simulation.
+inline LevelMap GetLevels(const SCMTerrainOld& terrain) {
+    return ToMap(terrain.GetModifiedNodes(true));
+}
+
+// Check that two terrain states have the same node levels, within the given tolerance.
+// Grid nodes missing from a state are at the (flat) undeformed level.
+inline bool Matches(const LevelMap& a, const LevelMap& b, double tolerance = 0) {
+    auto level = [](const LevelMap& m, const ChVector2i& ij) {
+        auto n = m.find(ij);
+        return n == m.end() ? 0.0 : n->second;
+    };
+    for (const auto* m : {&a, &b}) {
+        for (const auto& n : *m) {
+            if (std::abs(level(a, n.first) - level(b, n.first)) > tolerance)
+                return false;
+        }
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,191 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All rights reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Test of the SCMTerrainOld domain decomposition (POSIX only): a terrain split
+// in two subdomains, simulated by two child processes, must reproduce the
+// terrain simulated by a single process. The test covers the ghost nodes
+// received from the neighboring subdomain, the material raised by bulldozing
+// on nodes owned by the other subdomain, and the reduction of the contact
+// forces on shared bodies at their owner.
+// =============================================================================
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "utest_SCM_common.h"
+
+// Grid of the test terrain: 2 m x 1 m with 5 cm spacing (grid nodes -20..20 x -10..10).
+// Subdomain 0 owns the grid nodes with X index -20..-1, subdomain 1 those with X index 0..20.
+static const double size_x = 2.0;
+static const double size_y = 1.0;
+static const double delta = 0.05;
+
+static const double step_size = 1e-3;
+
+// Fixed boxes, pressed 2 cm into the terrain:
+// - box A straddles both subdomains (grid nodes -1..1 in X direction), with its COM in subdomain 1
+// - box B lies in subdomain 1 (grid nodes 0..5 in X direction), next to subdomain 0
+struct Setup {
+    Setup() {
+        sys.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+        box_a = AddBox(sys, ChVector3d(0.18, 0.18, 0.2), ChVector3d(0, 0.25, 0.08));
+        box_b = AddBox(sys, ChVector3d(0.27, 0.27, 0.2), ChVector3d(0.125, -0.25, 0.08));
+        box_a->SetFixed(true);
+        box_b->SetFixed(true);
+        terrain = CreateTerrain(sys, size_x, size_y, delta);
+        terrain->EnableBulldozing(true);
+        terrain->SetBulldozingParameters(30, 1.0, 0, 0);
+    }
+
+    ChSystemSMC sys;
+    std::shared_ptr<ChBody> box_a;
+    std::shared_ptr<ChBody> box_b;
+    std::unique_ptr<SCMTerrainOld> terrain;
+};
+
+// Terrain state after the first step: contact forces on the boxes and node levels
+struct Result {
+    bool active[2];
+    ChVector3d force[2];
+    LevelMap levels;
+};
+
+static Result GetResult(const Setup& setup) {
+    Result result;
+    ChVector3d torque;
+    result.active[0] = setup.terrain->GetContactForceBody(setup.box_a, result.force[0], torque);
+    result.active[1] = setup.terrain->GetContactForceBody(setup.box_b, result.force[1], torque);
+    result.levels = GetLevels(*setup.terrain);
+    return result;
+}
+
+static std::string ResultFile(int rank) {
+    return "scm_decomposition_" + std::to_string(rank) + ".txt";
+}
+
+static bool WriteResult(const Result& result, const std::string& filename) {
+    std::ofstream out(filename);
+    out.precision(17);
+    for (int k = 0; k < 2; k++)
+        out << result.active[k] << " " << result.force[k].x() << " " << result.force[k].y() << " "
+            << result.force[k].z() << "\n";
+    out << result.levels.size() << "\n";
+    for (const auto& n : result.levels)
+        out << n.first.x() << " " << n.first.y() << " " << n.second << "\n";
+    return out.good();
+}
+
+static bool ReadResult(Result& result, const std::string& filename) {
+    std::ifstream in(filename);
+    for (int k = 0; k < 2; k++)
+        in >> result.active[k] >> result.force[k].x() >> result.force[k].y() >> result.force[k].z();
+    size_t num_nodes = 0;
+    in >> num_nodes;
+    for (size_t n = 0; n < num_nodes && in; n++) {
+        int i, j;
+        double level;
+        in >> i >> j >> level;
+        result.levels[ChVector2i(i, j)] = level;
+    }
+    return !in.fail();
+}
+
+// Simulate one subdomain (in a child process) and save the result.
+static int RunSubdomain(const std::string& segment, int rank) {
+    try {
+        Setup setup;
+        setup.terrain->SetDomainDecomposition(segment, 2, 1, rank);
+        setup.terrain->AddSharedBody(setup.box_a, 0);
+        setup.terrain->AddSharedBody(setup.box_b, 1);
+        setup.sys.DoStepDynamics(step_size);
+        return WriteResult(GetResult(setup), ResultFile(rank)) ? 0 : 1;
+    } catch (std::exception& e) {
+        std::cerr << "Subdomain " << rank << ": " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+// Levels of the nodes in the given grid index range.
+static LevelMap Select(const LevelMap& levels, const ChVector2i& min, const ChVector2i& max) {
+    LevelMap selected;
+    for (const auto& n : levels) {
+        if (n.first.x() >= min.x() && n.first.x() <= max.x() && n.first.y() >= min.y() && n.first.y() <= max.y())
+            selected.insert(n);
+    }
+    return selected;
+}
+
+static bool Close(const ChVector3d& a, const ChVector3d& b) {
+    return (a - b).Length() <= 1e-9 * b.Length();
+}
+
+int main() {
+    // The subdomains are simulated by child processes, forked before any Chrono object is created
+    const std::string segment = "/scm_utest_" + std::to_string(getpid());
+    std::cout.flush();
+    std::cerr.flush();
+
+    pid_t children[2];
+    for (int rank = 0; rank < 2; rank++) {
+        children[rank] = fork();
+        if (children[rank] == 0) {
+            alarm(120);  // do not wait forever for a failed sibling
+            _exit(RunSubdomain(segment, rank));
+        }
+        CHECK(children[rank] > 0);
+    }
+    for (int rank = 0; rank < 2; rank++) {
+        int status = 0;
+        CHECK(children[rank] > 0 && waitpid(children[rank], &status, 0) == children[rank]);
+        CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+    if (num_failures > 0)
+        return TestResult("SCM domain decomposition");
+
+    Result sub[2];
+    for (int rank = 0; rank < 2; rank++) {
+        CHECK(ReadResult(sub[rank], ResultFile(rank)));
+        std::remove(ResultFile(rank).c_str());
+    }
+
+    // Reference: the entire terrain simulated by a single process
+    Setup ref_setup;
+    ref_setup.sys.DoStepDynamics(step_size);
+    Result ref = GetResult(ref_setup);
+    CHECK(ref.active[0] && ref.active[1]);
+
+    // Halo exchange: the ghost nodes of subdomain 0 around box B hold the levels computed by subdomain 1
+    CHECK(!Select(sub[1].levels, ChVector2i(0, -10), ChVector2i(7, -1)).empty());
+    CHECK(Matches(Select(sub[0].levels, ChVector2i(0, -10), ChVector2i(7, -1)),
+                  Select(sub[1].levels, ChVector2i(0, -10), ChVector2i(7, -1))));
+
+    // Material raised by subdomain 1 around box B on nodes of subdomain 0 is applied by subdomain 0
+    CHECK(ref.levels[ChVector2i(-1, -5)] > 0);
+    CHECK(Matches(Select(sub[0].levels, ChVector2i(-20, -10), ChVector2i(-1, -1)),
+                  Select(ref.levels, ChVector2i(-20, -10), ChVector2i(-1, -1)), 1e-12));
+    CHECK(Matches(Select(sub[1].levels, ChVector2i(0, -10), ChVector2i(20, -1)),
+                  Select(ref.levels, ChVector2i(0, -10), ChVector2i(20, -1)), 1e-12));
+
+    // Contact forces on the shared boxes are reduced at their owner (subdomain 1) only
+    CHECK(!sub[0].active[0] && !sub[0].active[1]);
+    CHECK(sub[1].active[0] && sub[1].active[1]);
+    CHECK(Close(sub[1].force[0], ref.force[0]));
+    CHECK(Close(sub[1].force[1], ref.force[1]));
+
+    return TestResult("SCM domain decomposition");
+}
@@ -0,0 +1,85 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All rights reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Test of the incremental maintenance of the SCMTerrainOld erosion domain: under
+// a box moved along a prescribed path, the erosion domain carried over from
+// step to step must match the domain rebuilt from scratch at every step, and so
+// must the node levels.
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "utest_SCM_common.h"
+
+// Grid of the test terrain: 2 m x 2 m with 4 cm spacing
+static const double size = 2.0;
+static const double delta = 0.04;
+
+static const int num_steps = 120;
+static const double step_size = 1e-3;
+
+// Bulldozing parameters. Without erosion refinement, node levels do not depend on the order in which the nodes of the
+// erosion domain are visited, so that both terrains must match exactly.
+static const double erosion_angle = 30;
+static const double flow_factor = 1.2;
+static const int erosion_iterations = 0;
+static const int erosion_propagations = 6;
+
+// Position of the box at the given step: along a circle, so that the box crosses the ruts of previous steps.
+static ChVector3d BoxPos(int step) {
+    double angle = 0.06 * step;
+    return ChVector3d(0.5 * std::cos(angle), 0.5 * std::sin(angle), 0.08);
+}
+
+struct Setup {
+    Setup() {
+        sys.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+        box = AddBox(sys, ChVector3d(0.2, 0.2, 0.2), BoxPos(0));
+        box->SetFixed(true);
+        terrain = CreateTerrain(sys, size, size, delta);
+        terrain->EnableBulldozing(true);
+        terrain->SetBulldozingParameters(erosion_angle, flow_factor, erosion_iterations, erosion_propagations);
+    }
+
+    ChSystemSMC sys;
+    std::shared_ptr<ChBody> box;
+    std::unique_ptr<SCMTerrainOld> terrain;
+};
+
+int main() {
+    Setup incremental;
+    Setup rebuilt;
+
+    bool same_domain = true;
+    bool same_levels = true;
+    int max_domain = 0;
+    for (int k = 0; k < num_steps; k++) {
+        incremental.box->SetPos(BoxPos(k));
+        incremental.sys.DoStepDynamics(step_size);
+
+        // Setting the bulldozing parameters discards the erosion domain
+        rebuilt.box->SetPos(BoxPos(k));
+        rebuilt.terrain->SetBulldozingParameters(erosion_angle, flow_factor, erosion_iterations, erosion_propagations);
+        rebuilt.sys.DoStepDynamics(step_size);
+
+        int n = incremental.terrain->GetNumErosionNodes();
+        same_domain = same_domain && n == rebuilt.terrain->GetNumErosionNodes();
+        same_levels = same_levels && Matches(GetLevels(*incremental.terrain), GetLevels(*rebuilt.terrain));
+        max_domain = std::max(max_domain, n);
+    }
+    CHECK(max_domain > 0);
+    CHECK(same_domain);
+    CHECK(same_levels);
+
+    return TestResult("SCM incremental erosion domain");
+}
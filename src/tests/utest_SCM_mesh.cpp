@@ -0,0 +1,216 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All rights reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Round-trip test of the SCMTerrainOld mesh export: the vertices, normals,
+// colors, and faces read back from OBJ, PLY, and STL files must reproduce the
+// visualization mesh of a deformed terrain.
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "utest_SCM_common.h"
+
+static std::vector<char> ReadFile(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    return std::vector<char>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+static std::uint32_t GetUint32LE(const char* p) {
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return u[0] | (u[1] << 8) | (u[2] << 16) | ((std::uint32_t)u[3] << 24);
+}
+
+static float GetFloatLE(const char* p) {
+    std::uint32_t u = GetUint32LE(p);
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// Check that a value read back matches the mesh value (text: 8 significant digits, binary: single precision).
+static bool Close(double read, double value) {
+    return std::abs(read - value) <= 1e-7 * std::max(1.0, std::abs(value));
+}
+
+static bool Close(const ChVector3d& read, const ChVector3d& value) {
+    return Close(read.x(), value.x()) && Close(read.y(), value.y()) && Close(read.z(), value.z());
+}
+
+static bool CheckObj(const std::string& filename, const ChTriangleMeshConnected& mesh) {
+    const auto& vertices = mesh.GetCoordsVertices();
+    const auto& normals = mesh.GetCoordsNormals();
+    const auto& faces = mesh.GetIndicesVertexes();
+    const auto& face_normals = mesh.GetIndicesNormals();
+    const bool has_normals = face_normals.size() == faces.size();
+
+    std::ifstream in(filename);
+    std::string line;
+    size_t nv = 0, nn = 0, nf = 0;
+    bool ok = true;
+    while (ok && std::getline(in, line)) {
+        std::istringstream s(line);
+        std::string tag;
+        s >> tag;
+        if (tag == "v" || tag == "vn") {
+            ChVector3d v;
+            s >> v.x() >> v.y() >> v.z();
+            if (tag == "v")
+                ok = !s.fail() && nv < vertices.size() && Close(v, vertices[nv++]);
+            else
+                ok = !s.fail() && nn < normals.size() && Close(v, normals[nn++]);
+        } else if (tag == "f") {
+            long long a[3], b[3];
+            if (has_normals) {
+                ok = std::sscanf(line.c_str(), "f %lld//%lld %lld//%lld %lld//%lld", &a[0], &b[0], &a[1], &b[1], &a[2],
+                                 &b[2]) == 6;
+            } else {
+                ok = std::sscanf(line.c_str(), "f %lld %lld %lld", &a[0], &a[1], &a[2]) == 3;
+            }
+            ok = ok && nf < faces.size();
+            for (int k = 0; ok && k < 3; k++) {
+                ok = a[k] == faces[nf][k] + 1 && (!has_normals || b[k] == face_normals[nf][k] + 1);
+            }
+            nf++;
+        }
+    }
+    return ok && nv == vertices.size() && nn == (has_normals ? normals.size() : 0) && nf == faces.size();
+}
+
+static bool CheckPly(const std::string& filename, const ChTriangleMeshConnected& mesh) {
+    const auto& vertices = mesh.GetCoordsVertices();
+    const auto& colors = mesh.GetCoordsColors();
+    const auto& faces = mesh.GetIndicesVertexes();
+    const bool has_colors = colors.size() == vertices.size();
+
+    auto data = ReadFile(filename);
+    const std::string end_header = "end_header\n";
+    auto end = std::search(data.begin(), data.end(), end_header.begin(), end_header.end());
+    if (end == data.end())
+        return false;
+    std::string header(data.begin(), end);
+    size_t offset = (end - data.begin()) + end_header.size();
+
+    std::string expected = "ply\nformat binary_little_endian 1.0\n";
+    if (header.compare(0, expected.size(), expected) != 0)
+        return false;
+    if (header.find("element vertex " + std::to_string(vertices.size()) + "\n") == std::string::npos ||
+        header.find("element face " + std::to_string(faces.size()) + "\n") == std::string::npos ||
+        (header.find("property uchar red\n") != std::string::npos) != has_colors)
+        return false;
+
+    const size_t vertex_size = has_colors ? 15 : 12;
+    const size_t face_size = 13;
+    if (data.size() != offset + vertices.size() * vertex_size + faces.size() * face_size)
+        return false;
+
+    const char* p = data.data() + offset;
+    for (size_t i = 0; i < vertices.size(); i++, p += vertex_size) {
+        ChVector3d v(GetFloatLE(p), GetFloatLE(p + 4), GetFloatLE(p + 8));
+        if (!Close(v, vertices[i]))
+            return false;
+        if (has_colors) {
+            const unsigned char* rgb = reinterpret_cast<const unsigned char*>(p + 12);
+            if (rgb[0] != ChClamp((int)std::lround(colors[i].R * 255), 0, 255) ||
+                rgb[1] != ChClamp((int)std::lround(colors[i].G * 255), 0, 255) ||
+                rgb[2] != ChClamp((int)std::lround(colors[i].B * 255), 0, 255))
+                return false;
+        }
+    }
+    for (size_t i = 0; i < faces.size(); i++, p += face_size) {
+        if (p[0] != 3)
+            return false;
+        for (int k = 0; k < 3; k++) {
+            if (GetUint32LE(p + 1 + 4 * k) != (std::uint32_t)faces[i][k])
+                return false;
+        }
+    }
+    return true;
+}
+
+static bool CheckStl(const std::string& filename, const ChTriangleMeshConnected& mesh) {
+    const auto& vertices = mesh.GetCoordsVertices();
+    const auto& faces = mesh.GetIndicesVertexes();
+
+    auto data = ReadFile(filename);
+    if (data.size() != 84 + 50 * faces.size() || GetUint32LE(data.data() + 80) != faces.size())
+        return false;
+
+    const char* p = data.data() + 84;
+    for (size_t i = 0; i < faces.size(); i++, p += 50) {
+        ChVector3d n(GetFloatLE(p), GetFloatLE(p + 4), GetFloatLE(p + 8));
+        const auto& v0 = vertices[faces[i][0]];
+        const auto& v1 = vertices[faces[i][1]];
+        const auto& v2 = vertices[faces[i][2]];
+        ChVector3d normal = Vcross(v1 - v0, v2 - v0);
+        normal.Normalize();
+        if (!Close(n, normal))
+            return false;
+        for (int k = 0; k < 3; k++) {
+            const char* q = p + 12 * (k + 1);
+            ChVector3d v(GetFloatLE(q), GetFloatLE(q + 4), GetFloatLE(q + 8));
+            if (!Close(v, vertices[faces[i][k]]))
+                return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    const std::string obj = "scm_mesh.obj";
+    const std::string ply = "scm_mesh.ply";
+    const std::string stl = "scm_mesh.stl";
+
+    ChSystemSMC sys;
+    sys.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+
+    // Terrain with visualization mesh (colored by node level), deformed over part of the patch
+    SCMTerrainOld terrain(&sys, true);
+    terrain.SetPlotType(SCMTerrainOld::PLOT_LEVEL, -0.05, 0.05);
+    terrain.Initialize(1.0, 0.8, 0.05);
+
+    std::vector<SCMTerrainOld::NodeLevel> nodes;
+    for (int j = -8; j <= 2; j++) {
+        for (int i = -4; i <= 10; i++)
+            nodes.push_back(std::make_pair(ChVector2i(i, j), 0.04 * std::sin(0.5 * i) * std::cos(0.4 * j)));
+    }
+    terrain.SetModifiedNodes(nodes);
+
+    // Export in all formats (the mesh is brought up to date first), then compare with the mesh
+    terrain.WriteMesh(obj, SCMTerrainOld::MESH_OBJ);
+    terrain.WriteMesh(ply, SCMTerrainOld::MESH_PLY);
+    terrain.WriteMesh(stl, SCMTerrainOld::MESH_STL);
+
+    const auto& mesh = *terrain.GetMesh()->GetMesh();
+    CHECK(mesh.GetCoordsVertices().size() == 21 * 17);
+    CHECK(mesh.GetIndicesVertexes().size() == 2 * 20 * 16);
+    CHECK(std::any_of(mesh.GetCoordsVertices().begin(), mesh.GetCoordsVertices().end(),
+                      [](const ChVector3d& v) { return std::abs(v.z()) > 0.01; }));
+    CHECK(CheckObj(obj, mesh));
+    CHECK(CheckPly(ply, mesh));
+    CHECK(CheckStl(stl, mesh));
+
+    std::remove(obj.c_str());
+    std::remove(ply.c_str());
+    std::remove(stl.c_str());
+
+    return TestResult("SCM mesh export round trip");
+}
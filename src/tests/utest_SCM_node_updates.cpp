@@ -0,0 +1,113 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All rights reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Test of the SCMTerrainOld bulk node updates: level updates must preserve the
+// deformation history of the nodes (plastic sinkage, yield pressure, shear),
+// and unsorted or duplicate updates must be rejected without modifying the
+// terrain.
+// =============================================================================
+
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "utest_SCM_common.h"
+
+// Grid of the test terrain: 1 m x 1 m with 5 cm spacing
+static const double size = 1.0;
+static const double delta = 0.05;
+
+static ChVector3d NodeLoc(const ChVector2i& ij) {
+    return ChVector3d(ij.x() * delta, ij.y() * delta, 1);
+}
+
+// Updates of all quantities over a block of grid nodes (row after row)
+static std::vector<SCMTerrainOld::NodeUpdate> FullUpdates() {
+    std::vector<SCMTerrainOld::NodeUpdate> updates;
+    for (int j = -2; j <= 2; j++) {
+        for (int i = -3; i <= 3; i++) {
+            SCMTerrainOld::NodeUpdate u;
+            u.ij = ChVector2i(i, j);
+            u.level = -0.01 - 0.001 * i;
+            u.sinkage_plastic = 0.02 + 0.001 * j;
+            u.sigma_yield = 1e5 + 1e3 * i;
+            u.kshear = 0.001 * (j + 3);
+            updates.push_back(u);
+        }
+    }
+    return updates;
+}
+
+// Check that the node quantities of the given updates are those of the terrain.
+static bool CheckHistory(const SCMTerrainOld& terrain, const std::vector<SCMTerrainOld::NodeUpdate>& updates) {
+    for (const auto& u : updates) {
+        auto info = terrain.GetNodeInfo(NodeLoc(u.ij));
+        if (info.sinkage_plastic != u.sinkage_plastic || info.sigma_yield != u.sigma_yield || info.kshear != u.kshear)
+            return false;
+    }
+    return true;
+}
+
+int main() {
+    ChSystemSMC sys;
+    auto terrain = CreateTerrain(sys, size, size, delta);
+
+    // Update of all node quantities (nodes unloaded at the given level)
+    auto full = FullUpdates();
+    terrain->ApplyNodeUpdates(full, SCMTerrainOld::UPDATE_SINKAGE_PLASTIC | SCMTerrainOld::UPDATE_SIGMA_YIELD |
+                                        SCMTerrainOld::UPDATE_KSHEAR);
+    CHECK(CheckHistory(*terrain, full));
+    bool full_ok = true;
+    for (const auto& u : full) {
+        full_ok = full_ok && terrain->GetNodeInfo(NodeLoc(u.ij)).sinkage == u.sinkage_plastic;
+        full_ok = full_ok && std::abs(terrain->GetHeight(NodeLoc(u.ij)) - u.level) < 1e-12;
+    }
+    CHECK(full_ok);
+    CHECK(GetLevels(*terrain).size() == full.size());
+
+    // Level-only update of every other node: node history is preserved
+    std::vector<SCMTerrainOld::NodeUpdate> levels;
+    for (size_t k = 0; k < full.size(); k += 2) {
+        SCMTerrainOld::NodeUpdate u;
+        u.ij = full[k].ij;
+        u.level = full[k].level + 0.005;
+        levels.push_back(u);
+    }
+    terrain->ApplyNodeUpdates(levels);
+    CHECK(CheckHistory(*terrain, full));
+    bool levels_ok = true;
+    for (const auto& u : levels) {
+        levels_ok = levels_ok && std::abs(terrain->GetHeight(NodeLoc(u.ij)) - u.level) < 1e-12;
+        levels_ok = levels_ok && std::abs(GetLevels(*terrain)[u.ij] - u.level) < 1e-12;
+    }
+    CHECK(levels_ok);
+
+    // Unsorted or duplicate updates are rejected, and the terrain is left unchanged
+    auto before = GetLevels(*terrain);
+    auto unsorted = levels;
+    std::swap(unsorted[1], unsorted[2]);
+    for (auto& u : unsorted)
+        u.level += 0.01;
+    CHECK(Throws([&]() { terrain->ApplyNodeUpdates(unsorted); }));
+
+    auto duplicate = levels;
+    duplicate.insert(duplicate.begin() + 3, duplicate[3]);
+    for (auto& u : duplicate)
+        u.level += 0.01;
+    CHECK(Throws([&]() { terrain->ApplyNodeUpdates(duplicate); }));
+
+    auto after = GetLevels(*terrain);
+    CHECK(after.size() == before.size() && Matches(after, before));
+    CHECK(CheckHistory(*terrain, full));
+
+    return TestResult("SCM bulk node updates");
+}
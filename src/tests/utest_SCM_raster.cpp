@@ -0,0 +1,169 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All rights reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Round-trip test of the SCMTerrainOld raster export: the samples read back
+// from a raster file (32-bit and 16-bit formats) must reproduce the exported
+// node quantity at every grid node.
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "utest_SCM_common.h"
+
+// Grid of the test terrain: 2 m x 1.5 m with 5 cm spacing (node indices in [-20, 20] x [-15, 15])
+static const double size_x = 2.0;
+static const double size_y = 1.5;
+static const double delta = 0.05;
+static const int nx = 20;
+static const int ny = 15;
+static const int width = 2 * nx + 1;
+static const int height = 2 * ny + 1;
+
+// Raster file read back: header and sample values (offset + scale * sample).
+struct Raster {
+    SCMTerrainOld::RasterHeader header;
+    std::vector<double> values;
+    size_t file_size;
+};
+
+static Raster ReadRaster(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    Raster r;
+    r.file_size = data.size();
+    std::memset(&r.header, 0, sizeof(r.header));
+    if (data.size() < sizeof(r.header))
+        return r;
+    std::memcpy(&r.header, data.data(), sizeof(r.header));
+
+    const auto& h = r.header;
+    const bool uint16 = (h.format == SCMTerrainOld::RASTER_UINT16);
+    const size_t sample_size = uint16 ? sizeof(std::uint16_t) : sizeof(float);
+    const size_t n = (size_t)h.width * (size_t)h.height;
+    if (data.size() != h.header_size + n * sample_size)
+        return r;
+    const char* samples = data.data() + h.header_size;
+    for (size_t k = 0; k < n; k++) {
+        if (uint16) {
+            std::uint16_t s;
+            std::memcpy(&s, samples + k * sample_size, sizeof(s));
+            r.values.push_back(h.offset + h.scale * s);
+        } else {
+            float s;
+            std::memcpy(&s, samples + k * sample_size, sizeof(s));
+            r.values.push_back(h.offset + h.scale * s);
+        }
+    }
+    return r;
+}
+
+static bool ValidHeader(const SCMTerrainOld::RasterHeader& h,
+                        SCMTerrainOld::DataPlotType field,
+                        SCMTerrainOld::RasterFormat format) {
+    return std::memcmp(h.magic, "SCMRAST", 8) == 0 && h.version == 1 &&
+           h.header_size == sizeof(SCMTerrainOld::RasterHeader) && h.width == width && h.height == height &&
+           h.field == field && h.format == format && std::abs(h.x0 + nx * delta) < 1e-12 &&
+           std::abs(h.y0 + ny * delta) < 1e-12 && h.delta == delta;
+}
+
+// Largest difference between the raster values and the reference values (raster order).
+static double MaxError(const Raster& r, const std::vector<double>& ref) {
+    if (r.values.size() != ref.size())
+        return 1e30;
+    double err = 0;
+    for (size_t k = 0; k < ref.size(); k++)
+        err = std::max(err, std::abs(r.values[k] - ref[k]));
+    return err;
+}
+
+int main() {
+    const std::string filename = "scm_raster.dat";
+
+    ChSystemSMC sys;
+    sys.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+    SCMTerrainOld terrain(&sys, false);
+    terrain.Initialize(size_x, size_y, delta);
+
+    // Deform an off-center block (including nodes on the patch boundary), raising and lowering nodes
+    std::vector<SCMTerrainOld::NodeUpdate> updates;
+    for (int j = -ny; j <= 4; j++) {
+        for (int i = 3; i <= nx; i++) {
+            SCMTerrainOld::NodeUpdate u;
+            u.ij = ChVector2i(i, j);
+            u.level = 0.03 * std::sin(0.4 * i + 0.3 * j);
+            u.sinkage_plastic = 0.001 * (i - j + ny);
+            updates.push_back(u);
+        }
+    }
+    terrain.ApplyNodeUpdates(updates, SCMTerrainOld::UPDATE_SINKAGE_PLASTIC);
+
+    // Reference values in raster order (row after row, starting at grid node (-nx, -ny))
+    std::vector<double> ref_level(width * height, 0.0);
+    for (const auto& n : terrain.GetModifiedNodes(true))
+        ref_level[(n.first.x() + nx) + width * (n.first.y() + ny)] = n.second;
+    std::vector<double> ref_plastic(width * height);
+    SCMTerrainOld::NodeInfoBuffers buffers;
+    buffers.sinkage_plastic = ref_plastic.data();
+    terrain.ExportNodeInfo(ChVector2i(-nx, -ny), width, height, buffers);
+
+    double level_range = 0.06;
+    double plastic_range = 0.001 * (nx + 2 * ny);
+
+    // 32-bit samples: exact up to float rounding
+    terrain.WriteRaster(filename, SCMTerrainOld::PLOT_LEVEL, SCMTerrainOld::RASTER_FLOAT32);
+    auto r = ReadRaster(filename);
+    CHECK(ValidHeader(r.header, SCMTerrainOld::PLOT_LEVEL, SCMTerrainOld::RASTER_FLOAT32));
+    CHECK(r.header.offset == 0 && r.header.scale == 1);
+    CHECK(r.file_size == sizeof(SCMTerrainOld::RasterHeader) + width * height * sizeof(float));
+    CHECK(MaxError(r, ref_level) <= 1e-6 * level_range);
+
+    terrain.WriteRaster(filename, SCMTerrainOld::PLOT_SINKAGE_PLASTIC, SCMTerrainOld::RASTER_FLOAT32);
+    r = ReadRaster(filename);
+    CHECK(ValidHeader(r.header, SCMTerrainOld::PLOT_SINKAGE_PLASTIC, SCMTerrainOld::RASTER_FLOAT32));
+    CHECK(MaxError(r, ref_plastic) <= 1e-6 * plastic_range);
+
+    // 16-bit samples: within half a quantization step over the range of values
+    terrain.WriteRaster(filename, SCMTerrainOld::PLOT_LEVEL, SCMTerrainOld::RASTER_UINT16);
+    r = ReadRaster(filename);
+    CHECK(ValidHeader(r.header, SCMTerrainOld::PLOT_LEVEL, SCMTerrainOld::RASTER_UINT16));
+    CHECK(r.file_size == sizeof(SCMTerrainOld::RasterHeader) + width * height * sizeof(std::uint16_t));
+    CHECK(r.header.scale > 0 && r.header.scale <= level_range / 65535 * (1 + 1e-6));
+    CHECK(MaxError(r, ref_level) <= 0.5 * r.header.scale + 1e-6 * level_range);
+
+    terrain.WriteRaster(filename, SCMTerrainOld::PLOT_SINKAGE_PLASTIC, SCMTerrainOld::RASTER_UINT16);
+    r = ReadRaster(filename);
+    CHECK(ValidHeader(r.header, SCMTerrainOld::PLOT_SINKAGE_PLASTIC, SCMTerrainOld::RASTER_UINT16));
+    CHECK(MaxError(r, ref_plastic) <= 0.5 * r.header.scale + 1e-6 * plastic_range);
+
+    // A uniform field is exported with unit scale
+    SCMTerrainOld flat(&sys, false);
+    flat.Initialize(size_x, size_y, delta);
+    flat.WriteRaster(filename, SCMTerrainOld::PLOT_PRESSURE, SCMTerrainOld::RASTER_UINT16);
+    r = ReadRaster(filename);
+    CHECK(ValidHeader(r.header, SCMTerrainOld::PLOT_PRESSURE, SCMTerrainOld::RASTER_UINT16));
+    CHECK(r.header.scale == 1);
+    CHECK(MaxError(r, std::vector<double>(width * height, 0.0)) == 0);
+
+    std::remove(filename.c_str());
+
+    return TestResult("SCM raster export round trip");
+}
@@ -0,0 +1,128 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All rights reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Round-trip test of the SCMTerrainOld deformation recorder: the deformation of
+// a terrain under a sliding box is recorded and replayed on a fresh terrain,
+// which must reproduce the node levels of every recorded step (within the
+// quantization step), whatever the order in which frames are visited.
+// =============================================================================
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "utest_SCM_common.h"
+
+// Grid of the test terrain: 2 m x 2 m with 4 cm spacing
+static const double size = 2.0;
+static const double delta = 0.04;
+
+// Recording parameters
+static const int num_steps = 150;
+static const double step_size = 1e-3;
+static const int keyframe_interval = 40;
+static const int buffer_frames = 8;
+static const double resolution = 1e-6;
+
+// Tolerance on replayed levels (half a quantization step)
+static const double tolerance = 0.5 * resolution + 1e-12;
+
+int main() {
+    const std::string log = "scm_recording.dat";
+    const std::string truncated = "scm_recording_truncated.dat";
+
+    // Record the ruts of a box sliding over the terrain, keeping the levels of the terrain after each step
+    std::vector<LevelMap> recorded;
+    {
+        ChSystemSMC sys;
+        sys.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+        sys.SetGravitationalAcceleration(ChVector3d(0, 0, -9.81));
+
+        auto box = AddBox(sys, ChVector3d(0.3, 0.3, 0.2), ChVector3d(-0.5, 0, 0.11));
+        box->SetPosDt(ChVector3d(2, 0.5, 0));
+
+        auto terrain = CreateTerrain(sys, size, size, delta);
+        terrain->StartRecording(log, keyframe_interval, resolution, buffer_frames);
+        for (int k = 0; k < num_steps; k++) {
+            sys.DoStepDynamics(step_size);
+            recorded.push_back(GetLevels(*terrain));
+        }
+        terrain->StopRecording();
+        CHECK(!recorded.back().empty());
+    }
+
+    // Replay on a fresh terrain
+    {
+        ChSystemSMC sys;
+        sys.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+        auto terrain = CreateTerrain(sys, size, size, delta);
+        SCMTerrainOld::DeformationReplay replay(*terrain, log);
+        CHECK(replay.GetNumFrames() == num_steps);
+        CHECK(replay.GetFrame() == -1);
+
+        // Forward, one frame at a time
+        bool match = true;
+        while (replay.Advance())
+            match = match && Matches(recorded[replay.GetFrame()], GetLevels(*terrain), tolerance);
+        CHECK(match);
+        CHECK(replay.GetFrame() == num_steps - 1);
+        CHECK(!replay.Advance());
+
+        // Backward and forward jumps, across keyframes
+        for (int frame : {5, keyframe_interval + 3, 2, num_steps - 1, keyframe_interval, keyframe_interval - 1}) {
+            replay.Seek(frame);
+            CHECK(replay.GetFrame() == frame);
+            CHECK(Matches(recorded[frame], GetLevels(*terrain), tolerance));
+        }
+
+        // Seek by simulation time
+        for (int k = 1; k < num_steps; k++)
+            CHECK(replay.GetFrameTime(k) > replay.GetFrameTime(k - 1));
+        replay.SeekTime(replay.GetFrameTime(70));
+        CHECK(replay.GetFrame() == 70);
+        replay.SeekTime(0.5 * (replay.GetFrameTime(90) + replay.GetFrameTime(91)));
+        CHECK(replay.GetFrame() == 90);
+        CHECK(Matches(recorded[90], GetLevels(*terrain), tolerance));
+    }
+
+    // A log with an incomplete last frame (interrupted recording) is replayed up to the last complete frame
+    {
+        std::ifstream in(log, std::ios::binary);
+        std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(truncated, std::ios::binary);
+        out.write(data.data(), data.size() - 1);
+    }
+    {
+        ChSystemSMC sys;
+        sys.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+        auto terrain = CreateTerrain(sys, size, size, delta);
+        SCMTerrainOld::DeformationReplay replay(*terrain, truncated);
+        CHECK(replay.GetNumFrames() == num_steps - 1);
+        replay.Seek(num_steps);
+        CHECK(replay.GetFrame() == num_steps - 2);
+        CHECK(Matches(recorded[num_steps - 2], GetLevels(*terrain), tolerance));
+
+        // A log of a different grid is rejected
+        SCMTerrainOld other(&sys, false);
+        other.Initialize(size, size, 2 * delta);
+        CHECK(Throws([&]() { SCMTerrainOld::DeformationReplay r(other, log); }));
+    }
+
+    std::remove(log.c_str());
+    std::remove(truncated.c_str());
+
+    return TestResult("SCM recorder round trip");
+}
@@ -0,0 +1,116 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All rights reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Test of the SCMTerrainOld region queries: the modified nodes returned for an
+// axis-aligned box and for a non-convex polygon must be those obtained by
+// filtering the complete list of modified nodes.
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "utest_SCM_common.h"
+
+// Grid of the test terrain: 1 m x 1 m with 5 cm spacing
+static const double size = 1.0;
+static const double delta = 0.05;
+
+static const int num_steps = 60;
+static const double step_size = 1e-3;
+
+// Position of the box at the given step: sliding in X direction, pressed 2 cm into the terrain
+static ChVector3d BoxPos(int step) {
+    return ChVector3d(-0.3 + 0.008 * step, 0.01, 0.08);
+}
+
+// Query regions, with boundaries away from the grid nodes.
+// The polygon is non-convex: a notch is cut in its upper side.
+static const ChVector2d box_min(-0.23, -0.11);
+static const ChVector2d box_max(0.17, 0.13);
+
+static const std::vector<ChVector2d> polygon = {
+    {-0.33, -0.14}, {0.27, -0.14}, {0.27, 0.13}, {0.01, 0.13}, {-0.07, -0.03}, {-0.16, 0.12}, {-0.33, 0.12}};
+
+// Point in polygon test (winding number).
+static bool Inside(const std::vector<ChVector2d>& poly, const ChVector2d& p) {
+    int winding = 0;
+    for (size_t i = 0; i < poly.size(); i++) {
+        const auto& a = poly[i];
+        const auto& b = poly[(i + 1) % poly.size()];
+        double side = (b.x() - a.x()) * (p.y() - a.y()) - (p.x() - a.x()) * (b.y() - a.y());
+        if (a.y() <= p.y() && b.y() > p.y() && side > 0)
+            winding++;
+        else if (a.y() > p.y() && b.y() <= p.y() && side < 0)
+            winding--;
+    }
+    return winding != 0;
+}
+
+// Filter a list of nodes by location.
+template <typename Filter>
+static LevelMap Select(const std::vector<SCMTerrainOld::NodeLevel>& nodes, Filter filter) {
+    LevelMap selected;
+    for (const auto& n : nodes) {
+        if (filter(ChVector2d(n.first.x() * delta, n.first.y() * delta)))
+            selected[n.first] = n.second;
+    }
+    return selected;
+}
+
+// Check that a query result (without duplicates) matches the expected nodes.
+static bool Same(const std::vector<SCMTerrainOld::NodeLevel>& result, const LevelMap& expected) {
+    auto map = ToMap(result);
+    return result.size() == expected.size() && map.size() == expected.size() && Matches(map, expected);
+}
+
+int main() {
+    ChSystemSMC sys;
+    sys.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+
+    auto box = AddBox(sys, ChVector3d(0.2, 0.2, 0.2), BoxPos(0));
+    box->SetFixed(true);
+
+    auto terrain = CreateTerrain(sys, size, size, delta);
+
+    auto in_box = [](const ChVector2d& p) {
+        return p.x() >= box_min.x() && p.x() <= box_max.x() && p.y() >= box_min.y() && p.y() <= box_max.y();
+    };
+    auto in_polygon = [](const ChVector2d& p) { return Inside(polygon, p); };
+
+    bool box_ok = true;
+    bool polygon_ok = true;
+    size_t num_selected = 0;
+    for (int k = 0; k < num_steps; k++) {
+        box->SetPos(BoxPos(k));
+        sys.DoStepDynamics(step_size);
+
+        for (bool all_nodes : {false, true}) {
+            auto nodes = terrain->GetModifiedNodes(all_nodes);
+            auto expected_box = Select(nodes, in_box);
+            auto expected_polygon = Select(nodes, in_polygon);
+            box_ok = box_ok && Same(terrain->GetModifiedNodes(box_min, box_max, all_nodes), expected_box);
+            polygon_ok = polygon_ok && Same(terrain->GetModifiedNodes(polygon, all_nodes), expected_polygon);
+            num_selected = std::max(num_selected, expected_polygon.size());
+        }
+    }
+    CHECK(box_ok);
+    CHECK(polygon_ok);
+    CHECK(num_selected > 0);
+
+    // The notch of the polygon excludes modified nodes
+    auto all = ToMap(terrain->GetModifiedNodes(true));
+    CHECK(all.count(ChVector2i(-1, 1)) == 1);
+    CHECK(!in_polygon(ChVector2d(-0.05, 0.05)));
+
+    return TestResult("SCM region queries");
+}
@@ -0,0 +1,122 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All rights reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Test of the SCMTerrainOld state snapshots: readers created in another thread
+// while the terrain is stepped must see a consistent state, namely the terrain
+// state at the end of the SCM step identified by the reader epoch.
+// =============================================================================
+
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "utest_SCM_common.h"
+
+// Grid of the test terrain: 1 m x 1 m with 5 cm spacing
+static const double size = 1.0;
+static const double delta = 0.05;
+
+static const int num_steps = 100;
+static const double step_size = 1e-3;
+
+// Position of the box at the given step: sliding in X direction, pressed 2 cm into the terrain
+static ChVector3d BoxPos(int step) {
+    return ChVector3d(-0.3 + 0.005 * step, 0, 0.08);
+}
+
+// Query locations along the path of the box
+static std::vector<ChVector3d> Probes() {
+    std::vector<ChVector3d> probes;
+    for (int i = -8; i <= 6; i++)
+        probes.push_back(ChVector3d(i * delta, 0.02, 1));
+    return probes;
+}
+
+// Terrain heights at the query locations, for a given snapshot epoch
+struct Sample {
+    unsigned int epoch;
+    std::vector<double> heights;
+};
+
+static Sample Query(const SCMTerrainOld::StateReader& reader, const std::vector<ChVector3d>& probes) {
+    Sample sample;
+    sample.epoch = reader.GetEpoch();
+    for (const auto& p : probes)
+        sample.heights.push_back(reader.GetHeight(p));
+    return sample;
+}
+
+int main() {
+    ChSystemSMC sys;
+    sys.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+
+    auto box = AddBox(sys, ChVector3d(0.2, 0.2, 0.2), BoxPos(0));
+    box->SetFixed(true);
+
+    auto terrain = CreateTerrain(sys, size, size, delta);
+    terrain->EnableStateSnapshots(true);
+
+    const auto probes = Probes();
+
+    // Terrain heights at the end of each step, keyed by snapshot epoch (recorded by the simulation thread)
+    std::map<unsigned int, std::vector<double>> states;
+    bool same_heights = true;
+    auto record = [&]() {
+        SCMTerrainOld::StateReader reader(*terrain);
+        auto sample = Query(reader, probes);
+        for (size_t k = 0; k < probes.size(); k++)
+            same_heights = same_heights && sample.heights[k] == terrain->GetHeight(probes[k]);
+        states[sample.epoch] = sample.heights;
+    };
+    record();
+
+    // Readers created concurrently with the SCM steps, each queried twice
+    std::atomic<bool> done(false);
+    std::vector<Sample> samples;
+    bool consistent = true;
+    std::thread query([&]() {
+        while (!done.load()) {
+            SCMTerrainOld::StateReader reader(*terrain);
+            auto first = Query(reader, probes);
+            std::this_thread::yield();
+            auto second = Query(reader, probes);
+            consistent = consistent && first.epoch == second.epoch && first.heights == second.heights;
+            samples.push_back(first);
+        }
+    });
+
+    for (int k = 0; k < num_steps; k++) {
+        box->SetPos(BoxPos(k));
+        sys.DoStepDynamics(step_size);
+        record();
+    }
+    done = true;
+    query.join();
+
+    CHECK(same_heights);
+    CHECK(consistent);
+    CHECK(states.size() == num_steps + 1);
+    CHECK(states.begin()->second != states.rbegin()->second);
+
+    // Each reader saw the terrain state of a completed step
+    CHECK(!samples.empty());
+    bool known_states = true;
+    for (const auto& s : samples) {
+        auto state = states.find(s.epoch);
+        known_states = known_states && state != states.end() && state->second == s.heights;
+    }
+    CHECK(known_states);
+
+    return TestResult("SCM state snapshot readers");
+}
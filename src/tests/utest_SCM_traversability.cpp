@@ -0,0 +1,128 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All rights reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Test of the SCMTerrainOld traversability map: the map maintained incrementally
+// over successive terrain modifications must match the map created from the
+// final terrain state, and the cell summaries computed directly from the node
+// levels.
+// =============================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "utest_SCM_common.h"
+
+// Grid of the test terrain: 1 m x 0.8 m with 5 cm spacing (grid nodes -10..10 x -8..8)
+static const double size_x = 1.0;
+static const double size_y = 0.8;
+static const double delta = 0.05;
+static const int nx = 10;
+static const int ny = 8;
+
+// Cells of 4 x 4 grid nodes (the last row and column of cells are partial)
+static const double cell_size = 0.2;
+static const int cell_nodes = 4;
+
+static const int num_batches = 5;
+
+// Nodes modified in the given batch: overlapping rectangles moving across the grid, up to its corner
+static std::vector<SCMTerrainOld::NodeLevel> Batch(int b) {
+    std::vector<SCMTerrainOld::NodeLevel> nodes;
+    for (int j = std::max(-ny, -8 + 3 * b); j <= std::min(ny, -2 + 3 * b); j++) {
+        for (int i = std::max(-nx, -10 + 4 * b); i <= std::min(nx, -4 + 4 * b); i++)
+            nodes.push_back(std::make_pair(ChVector2i(i, j), 0.02 * std::sin(0.7 * i + b) * std::cos(0.5 * j - b)));
+    }
+    return nodes;
+}
+
+// Check that two maps are identical.
+static bool SameMaps(const std::vector<SCMTerrainOld::TraversabilityCell>& a,
+                     const std::vector<SCMTerrainOld::TraversabilityCell>& b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t ic = 0; ic < a.size(); ic++) {
+        if (a[ic].level_min != b[ic].level_min || a[ic].level_max != b[ic].level_max ||
+            a[ic].level_mean != b[ic].level_mean || a[ic].sinkage_max != b[ic].sinkage_max ||
+            a[ic].slope != b[ic].slope)
+            return false;
+    }
+    return true;
+}
+
+// Check the map cells against summaries computed from the node levels (undeformed nodes are at zero level).
+static bool CheckMap(const std::vector<SCMTerrainOld::TraversabilityCell>& map, int width, const LevelMap& levels) {
+    auto level = [&levels](int i, int j) {
+        auto n = levels.find(ChVector2i(std::min(i, nx), std::min(j, ny)));
+        return n == levels.end() ? 0.0 : n->second;
+    };
+    auto close = [](double a, double b) { return std::abs(a - b) <= 1e-6 * std::max(1.0, std::abs(b)); };
+
+    for (size_t ic = 0; ic < map.size(); ic++) {
+        int i0 = (int)(ic % width) * cell_nodes - nx;
+        int j0 = (int)(ic / width) * cell_nodes - ny;
+        double min = 1e30, max = -1e30, sum = 0, slope = 0;
+        int n = 0;
+        for (int j = j0; j < j0 + cell_nodes && j <= ny; j++) {
+            for (int i = i0; i < i0 + cell_nodes && i <= nx; i++) {
+                double z = level(i, j);
+                min = std::min(min, z);
+                max = std::max(max, z);
+                sum += z;
+                n++;
+                double dx = level(i + 1, j) - z;
+                double dy = level(i, j + 1) - z;
+                slope = std::max(slope, std::atan(std::sqrt(dx * dx + dy * dy) / delta));
+            }
+        }
+        const auto& cell = map[ic];
+        if (!close(cell.level_min, min) || !close(cell.level_max, max) || !close(cell.level_mean, sum / n) ||
+            cell.sinkage_max != 0 || !close(cell.slope, slope))
+            return false;
+    }
+    return true;
+}
+
+int main() {
+    ChSystemSMC sys;
+    auto terrain = CreateTerrain(sys, size_x, size_y, delta);
+    terrain->EnableTraversabilityMap(true, cell_size);
+
+    CHECK(terrain->GetTraversabilityCellSize() == cell_nodes * delta);
+    CHECK(terrain->GetTraversabilityMapWidth() == 6);
+    CHECK(terrain->GetTraversabilityMapHeight() == 5);
+    int width = terrain->GetTraversabilityMapWidth();
+
+    // Map of the undeformed terrain
+    CHECK(CheckMap(terrain->GetTraversabilityMap(), width, LevelMap()));
+
+    // Map updated after each batch of modified nodes
+    bool incremental_ok = true;
+    bool same_maps = true;
+    for (int b = 0; b < num_batches; b++) {
+        terrain->SetModifiedNodes(Batch(b));
+        auto levels = GetLevels(*terrain);
+        const auto& map = terrain->GetTraversabilityMap();
+        incremental_ok = incremental_ok && CheckMap(map, width, levels);
+
+        // Map created from the current terrain state
+        ChSystemSMC sys_fresh;
+        auto fresh = CreateTerrain(sys_fresh, size_x, size_y, delta);
+        fresh->SetModifiedNodes(terrain->GetModifiedNodes(true));
+        fresh->EnableTraversabilityMap(true, cell_size);
+        same_maps = same_maps && SameMaps(map, fresh->GetTraversabilityMap());
+    }
+    CHECK(incremental_ok);
+    CHECK(same_maps);
+
+    return TestResult("SCM traversability map");
+}
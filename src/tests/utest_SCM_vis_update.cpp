@@ -0,0 +1,85 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All rights reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Test of the lazy update of the SCMTerrainOld visualization mesh: with a mesh
+// update interval longer than the simulated time, the SCM steps must not update
+// the mesh (zero visualization timer), and the deformation accumulated over the
+// steps must be applied when the mesh is requested.
+// =============================================================================
+
+#include <cmath>
+#include <memory>
+
+#include "utest_SCM_common.h"
+
+// Grid of the test terrain: 1 m x 1 m with 5 cm spacing (21 x 21 mesh vertices)
+static const double size = 1.0;
+static const double delta = 0.05;
+static const int nx = 10;
+static const int nvx = 2 * nx + 1;
+
+static const int num_steps = 100;
+static const double step_size = 1e-3;
+
+// Position of the box at the given step: sliding in X direction, pressed 2 cm into the terrain
+static ChVector3d BoxPos(int step) {
+    return ChVector3d(-0.3 + 0.005 * step, 0, 0.08);
+}
+
+// Check that the vertices of the visualization mesh are at the given node levels.
+static bool MeshMatches(const ChTriangleMeshConnected& mesh, const LevelMap& levels) {
+    const auto& vertices = mesh.GetCoordsVertices();
+    for (const auto& n : levels) {
+        int iv = (n.first.x() + nx) + nvx * (n.first.y() + nx);
+        if (std::abs(vertices[iv].z() - n.second) > 1e-12)
+            return false;
+    }
+    return true;
+}
+
+int main() {
+    ChSystemSMC sys;
+    sys.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+
+    auto box = AddBox(sys, ChVector3d(0.2, 0.2, 0.2), BoxPos(0));
+    box->SetFixed(true);
+
+    // Terrain with visualization mesh, updated at most once per second of simulation time
+    SCMTerrainOld terrain(&sys, true);
+    terrain.SetSoilParameters(2e6, 0, 1.1, 0, 30, 0.01, 2e8, 3e4);
+    terrain.SetMeshUpdateInterval(1.0);
+    terrain.Initialize(size, size, delta);
+
+    auto shape = terrain.GetMesh();
+    const auto& mesh = *shape->GetMesh();
+    CHECK(mesh.GetCoordsVertices().size() == nvx * nvx);
+
+    // Only the first step (first asset update) may update the mesh
+    bool zero_timer = true;
+    for (int k = 0; k < num_steps; k++) {
+        box->SetPos(BoxPos(k));
+        sys.DoStepDynamics(step_size);
+        if (k > 0)
+            zero_timer = zero_timer && terrain.GetTimerVisUpdate() == 0;
+    }
+    CHECK(zero_timer);
+
+    // The mesh lags behind the deformation until it is requested
+    auto levels = GetLevels(terrain);
+    CHECK(!levels.empty());
+    CHECK(!MeshMatches(mesh, levels));
+
+    CHECK(terrain.GetMesh() == shape);
+    CHECK(MeshMatches(mesh, levels));
+    CHECK(terrain.GetTimerVisUpdate() > 0);
+
+    return TestResult("SCM lazy visualization update");
+}
@@ -0,0 +1,74 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All rights reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Test of the SCMTerrainOld modified node visitor: the visited nodes must be
+// those returned by GetModifiedNodes, each visited once and, for the nodes
+// modified over the last step, row after row.
+// =============================================================================
+
+#include <memory>
+#include <vector>
+
+#include "utest_SCM_common.h"
+
+// Grid of the test terrain: 1 m x 1 m with 5 cm spacing
+static const double size = 1.0;
+static const double delta = 0.05;
+
+static const int num_steps = 60;
+static const double step_size = 1e-3;
+
+// Position of the box at the given step: sliding in X direction, pressed 2 cm into the terrain
+static ChVector3d BoxPos(int step) {
+    return ChVector3d(-0.3 + 0.008 * step, 0, 0.08);
+}
+
+int main() {
+    ChSystemSMC sys;
+    sys.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+
+    auto box = AddBox(sys, ChVector3d(0.2, 0.2, 0.2), BoxPos(0));
+    box->SetFixed(true);
+
+    auto terrain = CreateTerrain(sys, size, size, delta);
+    terrain->EnableBulldozing(true);
+
+    bool last_step_ok = true;
+    bool all_nodes_ok = true;
+    for (int k = 0; k < num_steps; k++) {
+        box->SetPos(BoxPos(k));
+        sys.DoStepDynamics(step_size);
+
+        // Nodes modified over the last step: same list as GetModifiedNodes (in row order)
+        std::vector<SCMTerrainOld::NodeLevel> visited;
+        terrain->VisitModifiedNodes([&visited](const ChVector2i& ij, double level) { visited.emplace_back(ij, level); });
+        last_step_ok = last_step_ok && !visited.empty() && visited == terrain->GetModifiedNodes(false);
+        for (size_t n = 1; n < visited.size(); n++)
+            last_step_ok = last_step_ok && Less()(visited[n - 1].first, visited[n].first);
+
+        // All modified nodes, each visited once
+        LevelMap visited_all;
+        size_t num_visits = 0;
+        terrain->VisitModifiedNodes(
+            [&](const ChVector2i& ij, double level) {
+                visited_all[ij] = level;
+                num_visits++;
+            },
+            true);
+        auto levels = GetLevels(*terrain);
+        all_nodes_ok = all_nodes_ok && num_visits == levels.size() && visited_all.size() == levels.size() &&
+                       Matches(visited_all, levels);
+    }
+    CHECK(last_step_ok);
+    CHECK(all_nodes_ok);
+
+    return TestResult("SCM modified node visitor");
+}
@@ -0,0 +1,138 @@
+// =============================================================================
+// PROJECT CHRONO - http://projectchrono.org
+//
+// Copyright (c) 2014 projectchrono.org
+// All rights reserved.
+//
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file at the top level of the distribution and at
+// http://projectchrono.org/license-chrono.txt.
+//
+// =============================================================================
+// Round-trip test of the compact delta format of SCMTerrainOld node levels:
+// encoded nodes must decode to the same grid nodes, with levels within the
+// quantization step, and malformed buffers must be rejected.
+// =============================================================================
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "utest_SCM_common.h"
+
+// Grid of the test terrain: 4 m x 2 m with 5 cm spacing (node indices in [-40, 40] x [-20, 20])
+static const double size_x = 4.0;
+static const double size_y = 2.0;
+static const double delta = 0.05;
+
+// Quantization step of the encoded levels
+static const double resolution = 1e-5;
+
+// Check that the decoded levels match the reference levels at the same grid nodes, within half a quantization step.
+static bool MatchesDecoded(const LevelMap& ref, const LevelMap& decoded) {
+    return ref.size() == decoded.size() && Matches(ref, decoded, 0.5 * resolution + 1e-12);
+}
+
+int main() {
+    ChSystemSMC sys;
+    sys.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+    auto terrain = CreateTerrain(sys, size_x, size_y, delta);
+
+    // Modified nodes: long runs, isolated nodes, gaps within rows, rows with negative and positive indices, and the
+    // grid corners
+    std::vector<SCMTerrainOld::NodeLevel> nodes;
+    for (int j = -20; j <= 20; j += 3) {
+        for (int i = -40; i <= 40; i++) {
+            if ((i + 2 * j) % 7 == 0 || (i > -10 && i < 25))
+                nodes.push_back(std::make_pair(ChVector2i(i, j), -0.05 * std::sin(0.3 * i) * std::cos(0.2 * j)));
+        }
+    }
+    nodes.push_back(std::make_pair(ChVector2i(-40, -19), 0.123456789));
+    nodes.push_back(std::make_pair(ChVector2i(40, 19), -0.987654321));
+    terrain->SetModifiedNodes(nodes);
+    auto ref = ToMap(terrain->GetModifiedNodes(true));
+    CHECK(ref.size() == nodes.size());
+
+    // Encode all nodes and decode them in the same terrain
+    std::vector<std::uint8_t> buffer;
+    terrain->EncodeModifiedNodes(buffer, resolution, true);
+    CHECK(MatchesDecoded(ref, ToMap(terrain->DecodeModifiedNodes(buffer.data(), buffer.size()))));
+    std::cout << nodes.size() << " nodes: " << buffer.size() << " bytes encoded, "
+              << nodes.size() * sizeof(SCMTerrainOld::NodeLevel) << " bytes as node list" << std::endl;
+    CHECK(buffer.size() < nodes.size() * sizeof(SCMTerrainOld::NodeLevel));
+
+    // Apply the encoded nodes to a replica terrain
+    {
+        ChSystemSMC sys2;
+        sys2.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+        auto replica = CreateTerrain(sys2, size_x, size_y, delta);
+        replica->SetModifiedNodes(buffer.data(), buffer.size());
+        CHECK(MatchesDecoded(ref, ToMap(replica->GetModifiedNodes(true))));
+    }
+
+    // An empty node list encodes to a valid buffer
+    {
+        ChSystemSMC sys3;
+        sys3.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+        auto empty = CreateTerrain(sys3, size_x, size_y, delta);
+        std::vector<std::uint8_t> empty_buffer;
+        empty->EncodeModifiedNodes(empty_buffer, resolution, true);
+        CHECK(empty->DecodeModifiedNodes(empty_buffer.data(), empty_buffer.size()).empty());
+    }
+
+    // A rejected buffer leaves the terrain unchanged, even if it starts with valid runs
+    {
+        ChSystemSMC sys4;
+        sys4.SetCollisionSystemType(ChCollisionSystem::Type::BULLET);
+        auto other = CreateTerrain(sys4, size_x, size_y, delta);
+        auto raised = nodes;
+        for (auto& n : raised)
+            n.second += 0.01;
+        other->SetModifiedNodes(raised);
+        std::vector<std::uint8_t> truncated;
+        other->EncodeModifiedNodes(truncated, resolution, true);
+        truncated.resize(truncated.size() * 3 / 4);
+
+        auto before = ToMap(terrain->GetModifiedNodes(true));
+        CHECK(Throws([&]() { terrain->SetModifiedNodes(truncated.data(), truncated.size()); }));
+        auto after = ToMap(terrain->GetModifiedNodes(true));
+        CHECK(after.size() == before.size() && Matches(before, after));
+    }
+
+    // Malformed buffers are rejected
+    CHECK(Throws([&]() { terrain->EncodeModifiedNodes(buffer, 0.0, true); }));
+    terrain->EncodeModifiedNodes(buffer, resolution, true);
+
+    auto decode = [&](const std::vector<std::uint8_t>& data) {
+        return [&terrain, data]() { terrain->DecodeModifiedNodes(data.data(), data.size()); };
+    };
+
+    // truncated data
+    CHECK(Throws(decode(std::vector<std::uint8_t>(buffer.begin(), buffer.begin() + buffer.size() / 2))));
+    CHECK(Throws(decode(std::vector<std::uint8_t>(buffer.begin(), buffer.begin() + 5))));
+
+    // unsupported format version
+    auto bad_version = buffer;
+    bad_version[0] ^= 0xFF;
+    CHECK(Throws(decode(bad_version)));
+
+    // non-positive resolution
+    auto bad_resolution = buffer;
+    bad_resolution[8] |= 0x80;  // sign bit of the (little endian) double
+    CHECK(Throws(decode(bad_resolution)));
+
+    // run of nodes longer than the remaining data
+    std::vector<std::uint8_t> header(buffer.begin(), buffer.begin() + 9);
+    auto overrun = header;
+    overrun.insert(overrun.end(), {0xFF, 0xFF, 0xFF, 0x0F, 0x00, 0x00, 0x00, 0x00});
+    CHECK(Throws(decode(overrun)));
+
+    // run leaving the grid (3 nodes starting at the last node of row 0)
+    auto outside = header;
+    outside.insert(outside.end(), {0x03, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00});
+    CHECK(Throws(decode(outside)));
+
+    return TestResult("SCM wire format round trip");
+}